@@ -0,0 +1,956 @@
+#include "ulid.hpp"
+#include "ulid_batch.hpp"
+#include "ulid_shared.hpp"
+#include "ulid_flat_map.hpp"
+#include "ulid_algorithm.hpp"
+#include "ulid_pack.hpp"
+#include "ulid_file.hpp"
+#include "ulid_stream.hpp"
+#include "ulid_pool.hpp"
+#include "ulid_wire.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Google Benchmark suite for cpp_ulid.
+// Build (Linux): cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build && ./build/cpp_ulid_bench
+//            or: g++ -std=c++23 -O2 bench.cpp -lbenchmark -lbenchmark_main -pthread
+// Build (Windows): cpp_ulid_bench.vcxproj, with Google Benchmark from vcpkg.
+//
+// The per-call benchmarks run once single-threaded and once on 4 threads; their Time column is
+// ns/op and the allocs/op counter comes from the operator new replacement below.
+
+// Counts heap allocations per thread. Aligned and nothrow forms fall through to the defaults uncounted.
+namespace {
+	thread_local std::uint64_t thread_allocations = 0;
+}
+
+void* operator new(std::size_t size){
+	++thread_allocations;
+	if(void* p = std::malloc(size == 0 ? 1 : size)){
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // GCC can't see that new above is malloc
+#endif
+void operator delete(void* p) noexcept{ std::free(p); }
+void operator delete(void* p, std::size_t) noexcept{ std::free(p); }
+
+namespace {
+	using ulid::ulid_t;
+
+	std::vector<ulid_t> make_ids(std::size_t n){
+		std::vector<ulid_t> ids(n);
+		for(auto& id : ids){
+			id = ulid_t::generate();
+		}
+		return ids;
+	}
+
+	// Sets the allocs/op counter from the heap allocations made on this thread since construction.
+	class allocation_counter final{
+		std::uint64_t start = thread_allocations;
+	public:
+		void report(benchmark::State& state, std::int64_t ops_per_iteration = 1) const{
+			const auto ops = static_cast<double>(state.iterations() * ops_per_iteration);
+			state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(thread_allocations - start) / ops, benchmark::Counter::kAvgThreads);
+			state.SetItemsProcessed(state.iterations() * ops_per_iteration);
+		}
+	};
+
+	void single_and_multi_thread(benchmark::internal::Benchmark* b){
+		b->Threads(1)->Threads(4);
+	}
+
+	// Every per-call benchmark cycles through a fixed pool, so the input stays in cache.
+	constexpr std::size_t POOL = 4096;
+
+	void BM_Generate(benchmark::State& state){
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::generate());
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_Generate)->Apply(single_and_multi_thread);
+
+	void BM_GenerateMonotonic(benchmark::State& state){
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::generate_monotonic());
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_GenerateMonotonic)->Apply(single_and_multi_thread);
+
+	// Cost of a default-constructed generator: one fetch_add on the seed sequence, no syscall.
+	void BM_ConstructGenerator(benchmark::State& state){
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			ulid::generator gen{};
+			benchmark::DoNotOptimize(gen);
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_ConstructGenerator)->Apply(single_and_multi_thread);
+
+	void BM_ToString(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ids[i++ % POOL].to_string());
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_ToString)->Apply(single_and_multi_thread);
+
+	void BM_FromString(benchmark::State& state){
+		std::vector<std::string> texts;
+		for(const auto& id : make_ids(POOL)){
+			texts.push_back(id.to_string());
+		}
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::from_string(texts[i++ % POOL]));
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_FromString)->Apply(single_and_multi_thread);
+
+	// UUID text at a service boundary: the to_bytes() + hex loop idiom against to_uuid_chars().
+	void BM_ToUuid_BytesAndHexLoop(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			constexpr char HEX[] = "0123456789abcdef";
+			const auto bytes = ids[i++ % POOL].to_bytes();
+			std::array<char, 36> out{};
+			char* p = out.data();
+			for(std::size_t k = 0; k < bytes.size(); ++k){
+				if(k == 4 || k == 6 || k == 8 || k == 10){ *p++ = '-'; }
+				*p++ = HEX[bytes[k] >> 4];
+				*p++ = HEX[bytes[k] & 0xF];
+			}
+			benchmark::DoNotOptimize(out);
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_ToUuid_BytesAndHexLoop)->Apply(single_and_multi_thread);
+
+	void BM_ToUuidChars(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ids[i++ % POOL].to_uuid_chars());
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_ToUuidChars)->Apply(single_and_multi_thread);
+
+	void BM_FromUuidString(benchmark::State& state){
+		std::vector<std::string> texts;
+		for(const auto& id : make_ids(POOL)){
+			texts.push_back(id.to_uuid_string());
+		}
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::from_uuid_string(texts[i++ % POOL]));
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_FromUuidString)->Apply(single_and_multi_thread);
+
+	void BM_ReadableRoundtrip(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::from_readable_string(ids[i++ % POOL].to_readable_string()));
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_ReadableRoundtrip)->Apply(single_and_multi_thread);
+
+	void BM_Compare(benchmark::State& state){
+		const auto ids = make_ids(POOL + 1);
+		std::size_t i = 0;
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			const std::size_t k = i++ % POOL;
+			benchmark::DoNotOptimize(ids[k] < ids[k + 1]);
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_Compare)->Apply(single_and_multi_thread);
+
+	// One op = one ID placed; each iteration re-sorts a shuffled copy of the pool.
+	void BM_SortPool(benchmark::State& state){
+		auto shuffled = make_ids(POOL);
+		std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64{42});
+		std::vector<ulid_t> work(POOL);
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			std::copy(shuffled.begin(), shuffled.end(), work.begin());
+			std::sort(work.begin(), work.end());
+			benchmark::DoNotOptimize(work.data());
+		}
+		allocs.report(state, static_cast<std::int64_t>(POOL));
+	}
+	BENCHMARK(BM_SortPool)->Apply(single_and_multi_thread);
+
+	// Engines to swap in for RomuDuoJr. These follow the cpp_prngs interface that rnd::Random expects.
+	class SplitMix64 final{
+		std::uint64_t s;
+	public:
+		using result_type = std::uint64_t;
+		constexpr SplitMix64() noexcept : SplitMix64(0x9E3779B97F4A7C15ull){}
+		explicit constexpr SplitMix64(result_type seed) noexcept : s(seed){}
+		constexpr result_type operator()() noexcept{
+			std::uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+		constexpr SplitMix64 split() noexcept{ return SplitMix64{(*this)()}; }
+		constexpr void seed(result_type v) noexcept{ s = v; }
+		constexpr void discard(unsigned long long n) noexcept{ s += n * 0x9E3779B97F4A7C15ull; }
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return ~result_type{0}; }
+		constexpr bool operator==(const SplitMix64&) const noexcept = default;
+	};
+
+	class Xoshiro256ss final{
+		std::array<std::uint64_t, 4> s{};
+	public:
+		using result_type = std::uint64_t;
+		constexpr Xoshiro256ss() noexcept : Xoshiro256ss(0x9E3779B97F4A7C15ull){}
+		explicit constexpr Xoshiro256ss(result_type seed) noexcept{ this->seed(seed); }
+		constexpr result_type operator()() noexcept{
+			const std::uint64_t result = std::rotl(s[1] * 5, 7) * 9;
+			const std::uint64_t t = s[1] << 17;
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = std::rotl(s[3], 45);
+			return result;
+		}
+		constexpr Xoshiro256ss split() noexcept{ return Xoshiro256ss{(*this)()}; }
+		constexpr void seed(result_type v) noexcept{
+			SplitMix64 sm{v};
+			for(auto& word : s){ word = sm(); }
+		}
+		constexpr void discard(unsigned long long n) noexcept{ while(n--){ (*this)(); } }
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return ~result_type{0}; }
+		constexpr bool operator==(const Xoshiro256ss&) const noexcept = default;
+	};
+
+	// 32-bit output, so the generator draws three times per ID instead of twice.
+	class Pcg32 final{
+		std::uint64_t s;
+	public:
+		using result_type = std::uint32_t;
+		constexpr Pcg32() noexcept : Pcg32(0x748FEA9Bu){}
+		explicit constexpr Pcg32(result_type seed) noexcept : s(seed + 0x14057B7EF767814Full){}
+		constexpr result_type operator()() noexcept{
+			const std::uint64_t old = s;
+			s = old * 6364136223846793005ull + 1442695040888963407ull;
+			const auto xorshifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+			return std::rotr(xorshifted, static_cast<int>(old >> 59));
+		}
+		constexpr Pcg32 split() noexcept{ return Pcg32{(*this)()}; }
+		constexpr void seed(result_type v) noexcept{ *this = Pcg32{v}; }
+		constexpr void discard(unsigned long long n) noexcept{ while(n--){ (*this)(); } }
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return ~result_type{0}; }
+		constexpr bool operator==(const Pcg32&) const noexcept = default;
+	};
+
+	// The timestamp is fixed so only the engine's cost differs between the variants.
+	template<typename Engine>
+	void BM_GenerateEngine(benchmark::State& state){
+		ulid::basic_generator<Engine> gen{};
+		const allocation_counter allocs{};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(gen.generate(1'700'000'000'000));
+		}
+		allocs.report(state);
+	}
+	BENCHMARK(BM_GenerateEngine<RomuDuoJr>)->Apply(single_and_multi_thread);
+	BENCHMARK(BM_GenerateEngine<SplitMix64>)->Apply(single_and_multi_thread);
+	BENCHMARK(BM_GenerateEngine<Xoshiro256ss>)->Apply(single_and_multi_thread);
+	BENCHMARK(BM_GenerateEngine<Pcg32>)->Apply(single_and_multi_thread);
+	BENCHMARK(BM_GenerateEngine<ChaCha20>)->Apply(single_and_multi_thread); // ulid::secure_generator
+
+	void BM_GenerateLoop(benchmark::State& state){
+		std::vector<ulid_t> ids(static_cast<std::size_t>(state.range(0)));
+		for(auto _ : state){
+			for(auto& id : ids){
+				id = ulid_t::generate();
+			}
+			benchmark::DoNotOptimize(ids.data());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_GenerateLoop)->Arg(1 << 14);
+
+	void BM_GenerateThreadLocal(benchmark::State& state){
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::generate_monotonic());
+		}
+	}
+	BENCHMARK(BM_GenerateThreadLocal);
+
+	void BM_GenerateOwnedGenerator(benchmark::State& state){
+		ulid::generator gen;
+		for(auto _ : state){
+			benchmark::DoNotOptimize(gen.generate_monotonic());
+		}
+	}
+	BENCHMARK(BM_GenerateOwnedGenerator);
+
+	// Contention: every thread hammers one process-wide sequence.
+	void BM_SharedMonotonic_Cas(benchmark::State& state){
+		auto& gen = ulid::basic_shared_generator<RomuDuoJr, ulid::cached_ms_clock>::instance();
+		for(auto _ : state){
+			benchmark::DoNotOptimize(gen.generate_monotonic());
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_SharedMonotonic_Cas)->ThreadRange(1, 64)->UseRealTime();
+
+	void BM_SharedBlocks(benchmark::State& state){
+		auto& shared = ulid::basic_block_generator<RomuDuoJr, ulid::cached_ms_clock>::instance();
+		ulid::basic_block_generator<RomuDuoJr, ulid::cached_ms_clock>::local ids{shared};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ids.generate());
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_SharedBlocks)->ThreadRange(1, 64)->UseRealTime();
+
+	void BM_SharedMonotonic_Mutex(benchmark::State& state){
+		static std::mutex m;
+		static ulid::basic_generator<RomuDuoJr, ulid::cached_ms_clock> gen{};
+		for(auto _ : state){
+			std::scoped_lock lock{m};
+			benchmark::DoNotOptimize(gen.generate_monotonic());
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_SharedMonotonic_Mutex)->ThreadRange(1, 64)->UseRealTime();
+
+	// The request-thread side of a prefetch pool: a pop that hits the ring. Refills are untimed.
+	void BM_PrefetchPoolPop(benchmark::State& state){
+		ulid::prefetch_pool pool{{.capacity = 4096, .max_age_ms = 1000, .mode = ulid::refill_mode::manual}};
+		for(auto _ : state){
+			auto id = pool.try_pop();
+			if(!id){
+				state.PauseTiming();
+				pool.refill();
+				state.ResumeTiming();
+				id = pool.try_pop();
+			}
+			benchmark::DoNotOptimize(id);
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_PrefetchPoolPop);
+
+	// With the background producer; pops that outrun it fall back to generating inline.
+	void BM_PrefetchPoolPop_Background(benchmark::State& state){
+		static ulid::prefetch_pool pool{{.capacity = 1 << 16}};
+		for(auto _ : state){
+			benchmark::DoNotOptimize(pool.pop());
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK(BM_PrefetchPoolPop_Background)->ThreadRange(1, 8)->UseRealTime();
+
+	template<typename Clock>
+	void BM_ClockNow(benchmark::State& state){
+		for(auto _ : state){
+			benchmark::DoNotOptimize(Clock::now_ms());
+		}
+	}
+	BENCHMARK(BM_ClockNow<ulid::system_ms_clock>);
+	BENCHMARK(BM_ClockNow<ulid::coarse_ms_clock>);
+	BENCHMARK(BM_ClockNow<ulid::cached_ms_clock>);
+
+	template<typename Clock>
+	void BM_GenerateWithClock(benchmark::State& state){
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid_t::generate<Clock>());
+		}
+	}
+	BENCHMARK(BM_GenerateWithClock<ulid::system_ms_clock>);
+	BENCHMARK(BM_GenerateWithClock<ulid::coarse_ms_clock>);
+	BENCHMARK(BM_GenerateWithClock<ulid::cached_ms_clock>);
+
+	void BM_GenerateN(benchmark::State& state){
+		std::vector<ulid_t> ids(static_cast<std::size_t>(state.range(0)));
+		for(auto _ : state){
+			ulid_t::generate_n(ids);
+			benchmark::DoNotOptimize(ids.data());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_GenerateN)->Arg(1 << 14);
+
+	void BM_GenerateMonotonicN(benchmark::State& state){
+		std::vector<ulid_t> ids(static_cast<std::size_t>(state.range(0)));
+		for(auto _ : state){
+			ulid_t::generate_monotonic_n(ids);
+			benchmark::DoNotOptimize(ids.data());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_GenerateMonotonicN)->Arg(1 << 14);
+
+	void BM_SortIds(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::vector<ulid_t> work;
+		for(auto _ : state){
+			state.PauseTiming();
+			work = ids;
+			state.ResumeTiming();
+			std::sort(work.begin(), work.end());
+			benchmark::DoNotOptimize(work.data());
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_SortIds)->Arg(1 << 16)->Arg(1 << 20)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+
+	void BM_RadixSort(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		const auto threads = static_cast<unsigned>(state.range(1));
+		std::vector<ulid_t> work;
+		for(auto _ : state){
+			state.PauseTiming();
+			work = ids;
+			state.ResumeTiming();
+			if(threads == 1){
+				ulid::sort(work);
+			} else{
+				ulid::sort(work, threads);
+			}
+			benchmark::DoNotOptimize(work.data());
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_RadixSort)
+		->Args({1 << 16, 1})->Args({1 << 20, 1})->Args({10'000'000, 1})
+		->Args({10'000'000, 4})->Args({10'000'000, 0}) // 0 = every core
+		->Unit(benchmark::kMillisecond)->UseRealTime();
+
+	// The hand-rolled baseline: FNV-1a over all 16 bytes.
+	struct byte_hasher{
+		std::size_t operator()(const ulid_t& id) const noexcept{
+			std::uint64_t h = 0xCBF29CE484222325ull;
+			for(const auto b : id.to_bytes()){
+				h = (h ^ b) * 0x100000001B3ull;
+			}
+			return static_cast<std::size_t>(h);
+		}
+	};
+
+	template<typename Hash>
+	void BM_HashThroughput(benchmark::State& state){
+		const auto ids = make_ids(4096);
+		const Hash hash{};
+		for(auto _ : state){
+			std::size_t acc = 0;
+			for(const auto& id : ids){
+				acc += hash(id);
+			}
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_HashThroughput<std::hash<ulid_t>>);
+	BENCHMARK(BM_HashThroughput<byte_hasher>);
+
+	// Lookups in an unordered_map, plus how many keys share a bucket with an earlier key.
+	// Both hashes should land close to the ideal for a load factor of 1 (about n/e collisions).
+	template<typename Hash>
+	void BM_HashMapFind(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::unordered_map<ulid_t, std::uint64_t, Hash> map;
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			map.emplace(ids[i], i);
+		}
+		std::size_t collisions = 0;
+		for(std::size_t b = 0; b < map.bucket_count(); ++b){
+			if(map.bucket_size(b) > 1){ collisions += map.bucket_size(b) - 1; }
+		}
+		for(auto _ : state){
+			std::uint64_t acc = 0;
+			for(const auto& id : ids){
+				acc += map.find(id)->second;
+			}
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+		state.counters["bucket_collisions"] = static_cast<double>(collisions);
+	}
+	BENCHMARK(BM_HashMapFind<std::hash<ulid_t>>)->Arg(1 << 16);
+	BENCHMARK(BM_HashMapFind<byte_hasher>)->Arg(1 << 16);
+
+	void BM_HashMapFind_ByString(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::unordered_map<ulid_t, std::uint64_t, ulid::hasher, ulid::equal_to> map;
+		std::vector<std::string> keys;
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			map.emplace(ids[i], i);
+			keys.push_back(ids[i].to_string());
+		}
+		for(auto _ : state){
+			std::uint64_t acc = 0;
+			for(const auto& key : keys){
+				acc += map.find(std::string_view{key})->second;
+			}
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_HashMapFind_ByString)->Arg(1 << 16);
+
+	// Counts heap bytes for the unordered_map comparison below. malloc's own per-node
+	// header (typically 8-16 bytes) is not included, so the real gap is wider.
+	template<typename T>
+	struct counting_allocator{
+		using value_type = T;
+		std::size_t* bytes;
+		explicit counting_allocator(std::size_t* bytes) noexcept : bytes(bytes){}
+		template<typename U>
+		counting_allocator(const counting_allocator<U>& other) noexcept : bytes(other.bytes){}
+		T* allocate(std::size_t n){
+			*bytes += n * sizeof(T);
+			return std::allocator<T>{}.allocate(n);
+		}
+		void deallocate(T* p, std::size_t n) noexcept{
+			*bytes -= n * sizeof(T);
+			std::allocator<T>{}.deallocate(p, n);
+		}
+		template<typename U>
+		bool operator==(const counting_allocator<U>& other) const noexcept{ return bytes == other.bytes; }
+	};
+
+	void BM_IndexFind_UnorderedMap(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::size_t bytes = 0;
+		using alloc = counting_allocator<std::pair<const ulid_t, std::uint64_t>>;
+		std::unordered_map<ulid_t, std::uint64_t, std::hash<ulid_t>, std::equal_to<>, alloc> map(0, std::hash<ulid_t>{}, std::equal_to<>{}, alloc{&bytes});
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			map.emplace(ids[i], i);
+		}
+		for(auto _ : state){
+			std::uint64_t acc = 0;
+			for(const auto& id : ids){
+				acc += map.find(id)->second;
+			}
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+		state.counters["bytes_per_entry"] = static_cast<double>(bytes) / static_cast<double>(ids.size());
+	}
+	BENCHMARK(BM_IndexFind_UnorderedMap)->Arg(1 << 12)->Arg(900000);
+
+	void BM_IndexFind_FlatMap(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		ulid::flat_map<std::uint64_t> map;
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			map.insert(ids[i], i);
+		}
+		for(auto _ : state){
+			std::uint64_t acc = 0;
+			for(const auto& id : ids){
+				acc += map.find(id).value();
+			}
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+		state.counters["bytes_per_entry"] = static_cast<double>(map.memory_bytes()) / static_cast<double>(ids.size());
+	}
+	BENCHMARK(BM_IndexFind_FlatMap)->Arg(1 << 12)->Arg(900000);
+
+	// Building the map from scratch, from random IDs (0) and from one generate_monotonic_n() run (1),
+	// whose keys differ only in their low bits.
+	void BM_IndexInsert_FlatMap(benchmark::State& state){
+		std::vector<ulid_t> ids(1 << 20);
+		if(state.range(0) == 0){
+			ids = make_ids(ids.size());
+		} else{
+			ulid_t::generate_monotonic_n(ids);
+		}
+		for(auto _ : state){
+			ulid::flat_map<std::uint64_t> map;
+			for(std::size_t i = 0; i < ids.size(); ++i){
+				map.insert(ids[i], i);
+			}
+			benchmark::DoNotOptimize(map.size());
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_IndexInsert_FlatMap)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+	// 900000 entries sits near flat_map's 7/8 load limit; 4096 is just past it, its worst case.
+
+	// Lookups that miss: the other half of an index workload.
+	void BM_IndexMiss_FlatMap(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		const auto misses = make_ids(static_cast<std::size_t>(state.range(0)));
+		ulid::flat_map<std::uint64_t> map;
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			map.insert(ids[i], i);
+		}
+		for(auto _ : state){
+			std::size_t found = 0;
+			for(const auto& id : misses){
+				found += map.contains(id);
+			}
+			benchmark::DoNotOptimize(found);
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_IndexMiss_FlatMap)->Arg(1 << 20);
+
+	// One sorted segment spanning about a day, queried for random one-minute windows.
+	std::vector<ulid_t> make_sorted_day(std::size_t n){
+		ulid::generator gen{};
+		std::vector<ulid_t> ids(n);
+		for(std::size_t i = 0; i < n; ++i){
+			ids[i] = gen.generate(1'700'000'000'000 + (i * 86'400'000) / n);
+		}
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+
+	void BM_TimeRange_LowerBound(benchmark::State& state){
+		const auto ids = make_sorted_day(static_cast<std::size_t>(state.range(0)));
+		std::uint64_t t = 0;
+		for(auto _ : state){
+			const std::uint64_t t0 = 1'700'000'000'000 + (t++ * 7'919'000) % 86'400'000;
+			const auto first = std::lower_bound(ids.begin(), ids.end(), ulid_t::min_for_timestamp(t0));
+			const auto last = std::upper_bound(first, ids.end(), ulid_t::max_for_timestamp(t0 + 60'000));
+			benchmark::DoNotOptimize(last - first);
+		}
+	}
+	BENCHMARK(BM_TimeRange_LowerBound)->Arg(1 << 20)->Arg(10'000'000);
+
+	void BM_TimeRange_Interpolation(benchmark::State& state){
+		const auto ids = make_sorted_day(static_cast<std::size_t>(state.range(0)));
+		std::uint64_t t = 0;
+		for(auto _ : state){
+			const std::uint64_t t0 = 1'700'000'000'000 + (t++ * 7'919'000) % 86'400'000;
+			benchmark::DoNotOptimize(ulid::time_range(ids, t0, t0 + 60'000).size());
+		}
+	}
+	BENCHMARK(BM_TimeRange_Interpolation)->Arg(1 << 20)->Arg(10'000'000);
+
+	// Arg 0: ids from generate_n() (random column stored raw),
+	// arg 1: generate_monotonic_n() within one millisecond (random column delta-encoded).
+	std::vector<ulid_t> make_pack_input(std::int64_t kind){
+		std::vector<ulid_t> ids(4096);
+		if(kind == 0){
+			ulid_t::generate_n(ids);
+		} else{
+			ulid_t::generate_monotonic_n(ids);
+		}
+		return ids;
+	}
+
+	void BM_Pack(benchmark::State& state){
+		const auto ids = make_pack_input(state.range(0));
+		std::vector<std::byte> out(ulid::max_packed_size(ids.size()));
+		std::size_t size = 0;
+		for(auto _ : state){
+			size = *ulid::pack(ids, out);
+			benchmark::DoNotOptimize(out.data());
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+		state.counters["bytes_per_id"] = static_cast<double>(size) / static_cast<double>(ids.size());
+	}
+	BENCHMARK(BM_Pack)->Arg(0)->Arg(1);
+
+	void BM_Unpack(benchmark::State& state){
+		const auto ids = make_pack_input(state.range(0));
+		const auto packed = ulid::pack(ids);
+		std::vector<ulid_t> out(ids.size());
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid::unpack(packed, out));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_Unpack)->Arg(0)->Arg(1);
+
+	// Framing 16-byte binary IDs: the to_bytes() + copy idiom against write_to() / write_many().
+	void BM_Frame_ToBytesCopy(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::vector<std::byte> frame(POOL * 16);
+		for(auto _ : state){
+			for(std::size_t i = 0; i < POOL; ++i){
+				const auto bytes = ids[i].to_bytes();
+				std::copy(bytes.begin(), bytes.end(), reinterpret_cast<std::uint8_t*>(frame.data() + i * 16));
+			}
+			benchmark::DoNotOptimize(frame.data());
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(POOL));
+	}
+	BENCHMARK(BM_Frame_ToBytesCopy);
+
+	void BM_Frame_WriteMany(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::vector<std::byte> frame(POOL * 16);
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid::write_many(ids, frame));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(POOL));
+	}
+	BENCHMARK(BM_Frame_WriteMany);
+
+	void BM_Frame_ReadMany(benchmark::State& state){
+		const auto ids = make_ids(POOL);
+		std::vector<std::byte> frame(POOL * 16);
+		(void)ulid::write_many(ids, frame);
+		std::vector<ulid_t> out(POOL);
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid::read_many(frame, out));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(POOL));
+	}
+	BENCHMARK(BM_Frame_ReadMany);
+
+	// Opening is independent of file size: map, check the header, done.
+	void BM_MappedFile_OpenAndQuery(benchmark::State& state){
+		const auto ids = make_sorted_day(static_cast<std::size_t>(state.range(0)));
+		const auto path = std::filesystem::temp_directory_path() / "cpp_ulid_bench.ulids";
+		if(!ulid::write_sorted_file(path, ids)){
+			state.SkipWithError("could not write the test file");
+			return;
+		}
+		for(auto _ : state){
+			const auto file = ulid::mapped_file::open(path);
+			benchmark::DoNotOptimize(file->time_range(1'700'000'000'000 + 3'600'000, 1'700'000'000'000 + 3'660'000).size());
+		}
+		std::filesystem::remove(path);
+	}
+	BENCHMARK(BM_MappedFile_OpenAndQuery)->Arg(1 << 16)->Arg(10'000'000);
+
+	// A log-like text: one ULID per line followed by a short payload.
+	std::string make_log(std::size_t lines){
+		std::string text;
+		for(const auto& id : make_ids(lines)){
+			text += id.to_string();
+			text += ",level=info,msg=request served\n";
+		}
+		return text;
+	}
+
+	void BM_Stream_Getline(benchmark::State& state){
+		const auto text = make_log(65536);
+		for(auto _ : state){
+			std::istringstream in{text};
+			std::string line;
+			std::uint64_t acc = 0;
+			while(std::getline(in, line)){
+				if(const auto id = ulid_t::from_string(std::string_view{line}.substr(0, 26))){
+					acc += id->timestamp_ms();
+				}
+			}
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(text.size()));
+	}
+	BENCHMARK(BM_Stream_Getline);
+
+	void BM_Stream_Parser(benchmark::State& state){
+		const auto text = make_log(65536);
+		const auto chunk = static_cast<std::size_t>(state.range(0));
+		for(auto _ : state){
+			ulid::stream_parser parser{};
+			std::uint64_t acc = 0;
+			auto sink = [&acc](const ulid_t& id, std::string_view){ acc += id.timestamp_ms(); };
+			for(std::size_t pos = 0; pos < text.size(); pos += chunk){
+				parser.feed(std::span{text}.subspan(pos, std::min(chunk, text.size() - pos)), sink);
+			}
+			parser.finish(sink);
+			benchmark::DoNotOptimize(acc);
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(text.size()));
+	}
+	BENCHMARK(BM_Stream_Parser)->Arg(4096)->Arg(1 << 16);
+
+	void BM_ToReadableString(benchmark::State& state){
+		const auto ids = make_ids(4096);
+		for(auto _ : state){
+			for(const auto& id : ids){
+				benchmark::DoNotOptimize(id.to_readable_string());
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_ToReadableString);
+
+	void BM_ToReadableChars(benchmark::State& state){
+		const auto ids = make_ids(4096);
+		std::array<char, 36> buf{};
+		for(auto _ : state){
+			for(const auto& id : ids){
+				benchmark::DoNotOptimize(id.to_readable_chars(buf.data(), buf.data() + buf.size()));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_ToReadableChars);
+
+	void BM_FromReadableString(benchmark::State& state){
+		std::vector<std::string> texts;
+		for(const auto& id : make_ids(4096)){
+			texts.push_back(id.to_readable_string());
+		}
+		for(auto _ : state){
+			for(const auto& text : texts){
+				benchmark::DoNotOptimize(ulid_t::from_readable_string(text));
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(texts.size()));
+	}
+	BENCHMARK(BM_FromReadableString);
+
+	// A log line built the old way, via a temporary string, against the formatter.
+	void BM_FormatLine_ToString(benchmark::State& state){
+		const auto ids = make_ids(4096);
+		std::string line;
+		line.reserve(128);
+		for(auto _ : state){
+			for(const auto& id : ids){
+				line.clear();
+				std::format_to(std::back_inserter(line), "request {} done", id.to_string());
+				benchmark::DoNotOptimize(line.data());
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_FormatLine_ToString);
+
+	void BM_FormatLine_Formatter(benchmark::State& state){
+		const auto ids = make_ids(4096);
+		std::string line;
+		line.reserve(128);
+		for(auto _ : state){
+			for(const auto& id : ids){
+				line.clear();
+				std::format_to(std::back_inserter(line), "request {} done", id);
+				benchmark::DoNotOptimize(line.data());
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(ids.size()));
+	}
+	BENCHMARK(BM_FormatLine_Formatter);
+
+	void BM_EncodeLoop_ToChars(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::vector<char> out(ids.size() * 26);
+		for(auto _ : state){
+			char* dst = out.data();
+			for(const auto& id : ids){
+				id.to_chars(std::span<char, 26>{dst, 26});
+				dst += 26;
+			}
+			benchmark::DoNotOptimize(out.data());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_EncodeLoop_ToChars)->Arg(1 << 12);
+
+	void BM_EncodeMany(benchmark::State& state){
+		const auto level = static_cast<ulid::simd_level>(state.range(1));
+		if(!ulid::is_supported(level)){
+			state.SkipWithError("instruction set not supported on this CPU");
+			return;
+		}
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::vector<char> out(ids.size() * 26);
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid::encode_many(ids, out, level));
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_EncodeMany)
+		->ArgNames({"n", "simd"})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::scalar)})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::sse41)})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::avx2)})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::neon)});
+
+	void BM_DecodeLoop_FromString(benchmark::State& state){
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::string packed(ids.size() * 26, '\0');
+		ulid::encode_many(ids, packed);
+		std::vector<ulid_t> out(ids.size());
+		for(auto _ : state){
+			for(std::size_t i = 0; i < out.size(); ++i){
+				out[i] = ulid_t::from_string(std::string_view{packed}.substr(i * 26, 26)).value_or(ulid_t{});
+			}
+			benchmark::DoNotOptimize(out.data());
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_DecodeLoop_FromString)->Arg(1 << 12);
+
+	void BM_DecodeMany(benchmark::State& state){
+		const auto level = static_cast<ulid::simd_level>(state.range(1));
+		if(!ulid::is_supported(level)){
+			state.SkipWithError("instruction set not supported on this CPU");
+			return;
+		}
+		const auto ids = make_ids(static_cast<std::size_t>(state.range(0)));
+		std::string packed(ids.size() * 26, '\0');
+		ulid::encode_many(ids, packed);
+		std::vector<ulid_t> out(ids.size());
+		std::vector<std::uint64_t> invalid((ids.size() + 63) / 64);
+		for(auto _ : state){
+			benchmark::DoNotOptimize(ulid::decode_many(packed, out, invalid, level));
+			benchmark::ClobberMemory();
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_DecodeMany)
+		->ArgNames({"n", "simd"})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::scalar)})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::sse41)})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::avx2)})
+		->Args({1 << 12, static_cast<int>(ulid::simd_level::neon)});
+} // namespace
@@ -0,0 +1,219 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ULID_CHACHA20_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ChaCha20 as a random bit engine, for IDs that must not be predictable from earlier outputs.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+// Same interface as RomuDuoJr, so it drops into rnd::Random and ulid::basic_generator:
+//
+//   ulid::secure_generator gen{};   // = ulid::basic_generator<ChaCha20>
+//
+// The keystream is the original (DJB) ChaCha20 with 20 rounds, a 256-bit key, a 64-bit nonce
+// and a 64-bit block counter. Output is produced BLOCKS blocks (1 KiB) at a time into an
+// internal buffer; operator() just hands out the next 64-bit word. With SSE2 each refill runs
+// four blocks at a time, one per 32-bit lane; elsewhere, and in constant evaluation, it uses
+// the portable per-block code.
+//
+// Keying: from_entropy() takes the key and nonce from a caller-supplied 64-bit source, and
+// basic_generator feeds it OS entropy whenever it seeds itself. The seed(uint64) constructor
+// expands 64 bits into a key for reproducible tests and benchmarks only; 64 bits is not a key.
+class ChaCha20 final{
+	using u32 = std::uint32_t;
+	using u64 = std::uint64_t;
+
+public:
+	using result_type = u64;
+	static constexpr std::size_t BLOCKS = 16;						// per refill
+	static constexpr std::size_t WORDS = BLOCKS * 8;				// 64-bit outputs per refill
+
+	constexpr ChaCha20() noexcept : ChaCha20(0xFEEDFACEFEEDFACEULL){}
+
+	// Deterministic, NOT secret: the key is a splitmix64 expansion of seed.
+	explicit constexpr ChaCha20(u64 seed) noexcept{
+		for(std::size_t i = 0; i < 4; ++i){
+			const u64 v = splitmix64(seed);
+			key[2 * i] = static_cast<u32>(v);
+			key[2 * i + 1] = static_cast<u32>(v >> 32);
+		}
+		nonce = splitmix64(seed);
+	}
+
+	// Key and nonce straight from a source of 64-bit values, e.g. ulid::seeding::os_entropy.
+	template<typename Source>
+	[[nodiscard]] static constexpr ChaCha20 from_entropy(Source&& draw64) noexcept{
+		ChaCha20 e{0};
+		for(std::size_t i = 0; i < 4; ++i){
+			const u64 v = draw64();
+			e.key[2 * i] = static_cast<u32>(v);
+			e.key[2 * i + 1] = static_cast<u32>(v >> 32);
+		}
+		e.nonce = draw64();
+		return e;
+	}
+
+	// Explicit key, nonce and starting block, e.g. for known-answer tests.
+	[[nodiscard]] static constexpr ChaCha20 from_key(const std::array<u32, 8>& k, u64 nonce, u64 counter = 0) noexcept{
+		ChaCha20 e{0};
+		e.key = k;
+		e.nonce = nonce;
+		e.counter = counter;
+		return e;
+	}
+
+	constexpr void seed() noexcept{ *this = ChaCha20{}; }
+	constexpr void seed(result_type v) noexcept{ *this = ChaCha20{v}; }
+
+	constexpr result_type next() noexcept{
+		if(index == WORDS){
+			refill();
+		}
+		return buffer[index++];
+	}
+	constexpr result_type operator()() noexcept{ return next(); }
+
+	constexpr void discard(unsigned long long n) noexcept{
+		while(n != 0){
+			if(index == WORDS){
+				if(n >= WORDS){ // skip whole refills by moving the counter
+					counter += BLOCKS * (n / WORDS);
+					n %= WORDS;
+					continue;
+				}
+				refill();
+			}
+			const u64 step = n < WORDS - index ? n : WORDS - index;
+			index += static_cast<std::size_t>(step);
+			n -= step;
+		}
+	}
+
+	// A child keyed from this stream's next 320 bits: computationally independent of the parent.
+	constexpr ChaCha20 split() noexcept{
+		return from_entropy([this]() noexcept{ return next(); });
+	}
+
+	static constexpr result_type min() noexcept{ return std::numeric_limits<result_type>::min(); }
+	static constexpr result_type max() noexcept{ return std::numeric_limits<result_type>::max(); }
+
+	// The buffer is a function of the rest, so it is left out.
+	constexpr bool operator==(const ChaCha20& rhs) const noexcept{
+		return key == rhs.key && nonce == rhs.nonce && counter == rhs.counter && index == rhs.index;
+	}
+
+private:
+	std::array<u32, 8> key{};
+	u64 nonce = 0;
+	u64 counter = 0;					// next block to compute
+	std::size_t index = WORDS;			// next unread word of buffer; WORDS = empty
+	std::array<u64, WORDS> buffer{};
+
+	static constexpr u64 splitmix64(u64& state) noexcept{
+		u64 z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	static constexpr u32 rotl(u32 v, int r) noexcept{
+		return (v << r) | (v >> (32 - r));
+	}
+
+	static constexpr void quarter(std::array<u32, 16>& x, int a, int b, int c, int d) noexcept{
+		x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 16);
+		x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 12);
+		x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 8);
+		x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 7);
+	}
+
+	static constexpr std::array<u32, 4> SIGMA{0x61707865u, 0x3320646Eu, 0x79622D32u, 0x6B206574u}; // "expand 32-byte k"
+
+	// One keystream block into out[0..8), as little-endian word pairs: the keystream byte order on x86/ARM.
+	constexpr void block(u64 n, u64* out) const noexcept{
+		std::array<u32, 16> init{};
+		for(std::size_t w = 0; w < 4; ++w){ init[w] = SIGMA[w]; }
+		for(std::size_t w = 0; w < 8; ++w){ init[4 + w] = key[w]; }
+		init[12] = static_cast<u32>(n);
+		init[13] = static_cast<u32>(n >> 32);
+		init[14] = static_cast<u32>(nonce);
+		init[15] = static_cast<u32>(nonce >> 32);
+		auto x = init;
+		for(int round = 0; round < 10; ++round){ // 10 double rounds = 20 rounds
+			quarter(x, 0, 4, 8, 12); quarter(x, 1, 5, 9, 13); quarter(x, 2, 6, 10, 14); quarter(x, 3, 7, 11, 15);
+			quarter(x, 0, 5, 10, 15); quarter(x, 1, 6, 11, 12); quarter(x, 2, 7, 8, 13); quarter(x, 3, 4, 9, 14);
+		}
+		for(std::size_t w = 0; w < 8; ++w){
+			out[w] = static_cast<u64>(x[2 * w] + init[2 * w]) | (static_cast<u64>(x[2 * w + 1] + init[2 * w + 1]) << 32);
+		}
+	}
+
+#if defined(ULID_CHACHA20_SSE2)
+	template<int R>
+	static __m128i rotl4(__m128i v) noexcept{
+		return _mm_or_si128(_mm_slli_epi32(v, R), _mm_srli_epi32(v, 32 - R));
+	}
+
+	static void quarter4(__m128i& a, __m128i& b, __m128i& c, __m128i& d) noexcept{
+		a = _mm_add_epi32(a, b); d = rotl4<16>(_mm_xor_si128(d, a));
+		c = _mm_add_epi32(c, d); b = rotl4<12>(_mm_xor_si128(b, c));
+		a = _mm_add_epi32(a, b); d = rotl4<8>(_mm_xor_si128(d, a));
+		c = _mm_add_epi32(c, d); b = rotl4<7>(_mm_xor_si128(b, c));
+	}
+
+	// Blocks n .. n+3 into out[0..32), lane i of every vector belonging to block n+i.
+	void block4(u64 n, u64* out) const noexcept{
+		const auto word = [](u64 v) noexcept{ return static_cast<int>(static_cast<u32>(v)); };
+		__m128i init[16]; // not std::array: the vector type's alignment attribute is dropped in template arguments
+		for(std::size_t w = 0; w < 4; ++w){ init[w] = _mm_set1_epi32(static_cast<int>(SIGMA[w])); }
+		for(std::size_t w = 0; w < 8; ++w){ init[4 + w] = _mm_set1_epi32(static_cast<int>(key[w])); }
+		init[12] = _mm_set_epi32(word(n + 3), word(n + 2), word(n + 1), word(n));
+		init[13] = _mm_set_epi32(word((n + 3) >> 32), word((n + 2) >> 32), word((n + 1) >> 32), word(n >> 32));
+		init[14] = _mm_set1_epi32(word(nonce));
+		init[15] = _mm_set1_epi32(word(nonce >> 32));
+		__m128i x[16];
+		for(std::size_t w = 0; w < 16; ++w){ x[w] = init[w]; }
+		for(int round = 0; round < 10; ++round){
+			quarter4(x[0], x[4], x[8], x[12]); quarter4(x[1], x[5], x[9], x[13]); quarter4(x[2], x[6], x[10], x[14]); quarter4(x[3], x[7], x[11], x[15]);
+			quarter4(x[0], x[5], x[10], x[15]); quarter4(x[1], x[6], x[11], x[12]); quarter4(x[2], x[7], x[8], x[13]); quarter4(x[3], x[4], x[9], x[14]);
+		}
+		for(std::size_t w = 0; w < 8; ++w){ // interleave the word pairs into 64-bit outputs, two blocks per vector
+			const __m128i lo = _mm_add_epi32(x[2 * w], init[2 * w]);
+			const __m128i hi = _mm_add_epi32(x[2 * w + 1], init[2 * w + 1]);
+			alignas(16) std::array<u64, 4> pair{};
+			_mm_store_si128(reinterpret_cast<__m128i*>(pair.data()), _mm_unpacklo_epi32(lo, hi));		// blocks 0, 1
+			_mm_store_si128(reinterpret_cast<__m128i*>(pair.data() + 2), _mm_unpackhi_epi32(lo, hi));	// blocks 2, 3
+			for(std::size_t b = 0; b < 4; ++b){
+				out[b * 8 + w] = pair[b];
+			}
+		}
+	}
+#endif
+
+	// BLOCKS consecutive keystream blocks.
+	constexpr void refill() noexcept{
+#if defined(ULID_CHACHA20_SSE2)
+		if !consteval{
+			for(std::size_t b = 0; b < BLOCKS; b += 4){
+				block4(counter + b, buffer.data() + b * 8);
+			}
+			counter += BLOCKS;
+			index = 0;
+			return;
+		}
+#endif
+		for(std::size_t b = 0; b < BLOCKS; ++b){
+			block(counter + b, buffer.data() + b * 8);
+		}
+		counter += BLOCKS;
+		index = 0;
+	}
+};
@@ -1,15 +1,34 @@
 #pragma once
 #include "ulid.hpp"
+#include "ulid_batch.hpp"
+#include "ulid_shared.hpp"
+#include "ulid_flat_map.hpp"
+#include "ulid_algorithm.hpp"
+#include "ulid_pack.hpp"
+#include "ulid_file.hpp"
+#include "ulid_stream.hpp"
+#include "ulid_pool.hpp"
+#include "ulid_wire.hpp"
 #include <algorithm>
 #include <array>
 #include <cctype>
 #include <compare>
+#include <filesystem>
+#include <format>
 #include <gtest/gtest.h>
+#include <memory>
 #include <random>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
+#include <thread>
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace {
 	using ulid::ulid_t;
@@ -46,6 +65,65 @@ namespace {
 		return bytes;
 	}
 
+	// Tiny 32-bit engine (xorshift32) to exercise the 32-bit path of the generators.
+	class Xorshift32 final{
+		std::uint32_t s;
+	public:
+		using result_type = std::uint32_t;
+		constexpr Xorshift32() noexcept : Xorshift32(0x12345678u){}
+		explicit constexpr Xorshift32(result_type seed) noexcept : s(seed ? seed : 0x12345678u){}
+		constexpr result_type operator()() noexcept{
+			s ^= s << 13;
+			s ^= s >> 17;
+			s ^= s << 5;
+			return s;
+		}
+		constexpr Xorshift32 split() noexcept{ return Xorshift32{(*this)()}; }
+		constexpr void seed(result_type v) noexcept{ *this = Xorshift32{v}; }
+		constexpr void discard(unsigned long long n) noexcept{ while(n--){ (*this)(); } }
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return ~result_type{0}; }
+		constexpr bool operator==(const Xorshift32&) const noexcept = default;
+	};
+
+	// Always returns all ones, so the first ID of a millisecond already has its random field used up.
+	class AllOnes final{
+	public:
+		using result_type = std::uint64_t;
+		constexpr AllOnes() noexcept = default;
+		explicit constexpr AllOnes(result_type) noexcept{}
+		constexpr result_type operator()() noexcept{ return ~result_type{0}; }
+		constexpr AllOnes split() noexcept{ return {}; }
+		constexpr void seed(result_type) noexcept{}
+		constexpr void discard(unsigned long long) noexcept{}
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return ~result_type{0}; }
+		constexpr bool operator==(const AllOnes&) const noexcept = default;
+	};
+
+	// Alternates all ones and all ones minus one, so a fresh random field is one increment short of full.
+	class NearlyFull final{
+	public:
+		using result_type = std::uint64_t;
+		constexpr NearlyFull() noexcept = default;
+		explicit constexpr NearlyFull(result_type) noexcept{}
+		constexpr result_type operator()() noexcept{ return ~result_type{0} - (draws++ & 1); }
+		constexpr NearlyFull split() noexcept{ return {}; }
+		constexpr void seed(result_type) noexcept{ draws = 0; }
+		constexpr void discard(unsigned long long n) noexcept{ draws += n; }
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return ~result_type{0}; }
+		constexpr bool operator==(const NearlyFull&) const noexcept = default;
+	private:
+		result_type draws = 0;
+	};
+
+	// A clock tests can set; every read moves it forward by one millisecond.
+	struct stepping_clock final{
+		static inline std::uint64_t next = 0;
+		static std::uint64_t now_ms() noexcept{ return next++; }
+	};
+
 	TEST(Ulid, AllZeroBytesRoundtrip){
 		ulid_t zero{}; // default-initialized, all bytes zero
 		auto str = zero.to_string();
@@ -111,6 +189,416 @@ namespace {
 		}
 	}
 
+	TEST(Ulid, GenerateNFillsSpanWithUniqueIds){
+		std::vector<ulid_t> ids(4096);
+		ulid_t::generate_n(ids);
+
+		std::set<ulid_t> unique(ids.begin(), ids.end());
+		EXPECT_EQ(unique.size(), ids.size());
+		for(const auto& id : ids){
+			EXPECT_EQ(id.timestamp_ms(), ids.front().timestamp_ms()); // one clock read per batch
+		}
+	}
+
+	TEST(Ulid, GenerateMonotonicNIsStrictlyIncreasing){
+		std::vector<ulid_t> ids(4096);
+		ulid_t::generate_monotonic_n(ids);
+		for(std::size_t i = 1; i < ids.size(); ++i){
+			EXPECT_LT(ids[i - 1], ids[i]) << "Non-monotonic at index " << i;
+		}
+	}
+
+	TEST(Ulid, GenerateMonotonicNInterleavesWithGenerateMonotonic){
+		std::vector<ulid_t> seq;
+		std::array<ulid_t, 64> batch{};
+		for(int round = 0; round < 16; ++round){
+			seq.push_back(ulid_t::generate_monotonic());
+			ulid_t::generate_monotonic_n(batch);
+			seq.insert(seq.end(), batch.begin(), batch.end());
+		}
+		for(std::size_t i = 1; i < seq.size(); ++i){
+			EXPECT_LT(seq[i - 1], seq[i]) << "Non-monotonic at index " << i;
+		}
+	}
+
+	TEST(Ulid, GenerateFillsEveryRandomByte){
+		// OR together the random bytes of many IDs: every bit of all 10 bytes should show up,
+		// catching any byte that is left zero or copied from the wrong part of a draw.
+		std::array<ulid_t::byte, 10> seen_set{};
+		std::array<ulid_t::byte, 10> seen_clear{};
+		for(int i = 0; i < 256; ++i){
+			const auto bytes = ulid_t::generate().to_bytes();
+			for(std::size_t b = 0; b < 10; ++b){
+				seen_set[b] |= bytes[6 + b];
+				seen_clear[b] |= static_cast<ulid_t::byte>(~bytes[6 + b]);
+			}
+		}
+		for(std::size_t b = 0; b < 10; ++b){
+			EXPECT_EQ(seen_set[b], 0xFF) << "random byte " << b;
+			EXPECT_EQ(seen_clear[b], 0xFF) << "random byte " << b;
+		}
+	}
+
+	TEST(Ulid, ClockPoliciesTrackTheSystemClock){
+		const auto close_to_system = [](std::uint64_t ts){
+			const auto now = ulid::system_ms_clock::now_ms();
+			return ts + 100 >= now && ts <= now + 100;
+		};
+		EXPECT_TRUE(close_to_system(ulid::coarse_ms_clock::now_ms()));
+		EXPECT_TRUE(close_to_system(ulid::cached_ms_clock::now_ms()));
+		EXPECT_TRUE(close_to_system(ulid_t::generate<ulid::coarse_ms_clock>().timestamp_ms()));
+		EXPECT_TRUE(close_to_system(ulid_t::generate<ulid::cached_ms_clock>().timestamp_ms()));
+	}
+
+	TEST(Ulid, CachedClockAdvances){
+		const auto start = ulid::cached_ms_clock::now_ms();
+		std::this_thread::sleep_for(std::chrono::milliseconds{20});
+		EXPECT_GT(ulid::cached_ms_clock::now_ms(), start);
+	}
+
+	TEST(Ulid, MonotonicStaysIncreasingAcrossClockPolicies){
+		constexpr int N = 512;
+		std::vector<ulid_t> ids;
+		for(int i = 0; i < N; ++i){
+			switch(i % 3){
+			case 0: ids.push_back(ulid_t::generate_monotonic()); break;
+			case 1: ids.push_back(ulid_t::generate_monotonic<ulid::coarse_ms_clock>()); break; // may lag the others
+			default: ids.push_back(ulid_t::generate_monotonic<ulid::cached_ms_clock>()); break;
+			}
+		}
+		for(int i = 1; i < N; ++i){
+			EXPECT_LT(ids[i - 1], ids[i]) << "Non-monotonic at index " << i;
+		}
+	}
+
+	TEST(Ulid, GeneratorWithSameSeedIsDeterministic){
+		ulid::generator a{1234};
+		ulid::generator b{1234};
+		for(int i = 0; i < 100; ++i){
+			EXPECT_EQ(a.generate(1000), b.generate(1000));
+			EXPECT_EQ(a.generate_monotonic(2000 + i / 10), b.generate_monotonic(2000 + i / 10));
+		}
+	}
+
+	TEST(Ulid, GeneratorUsesExplicitTimestamp){
+		ulid::generator gen{7};
+		const std::uint64_t ts = 0x0123456789ABull;
+		EXPECT_EQ(gen.generate(ts).timestamp_ms(), ts);
+		EXPECT_EQ(gen.generate_monotonic(ts).timestamp_ms(), ts);
+
+		std::array<ulid_t, 16> batch{};
+		gen.generate_n(batch, ts);
+		for(const auto& id : batch){
+			EXPECT_EQ(id.timestamp_ms(), ts);
+		}
+	}
+
+	TEST(Ulid, GeneratorMonotonicSurvivesClockRollback){
+		ulid::generator gen{99};
+		std::vector<ulid_t> ids;
+		for(std::uint64_t ts : {5000ull, 5000ull, 4000ull, 4999ull, 5000ull, 5001ull, 10ull}){
+			ids.push_back(gen.generate_monotonic(ts));
+		}
+		for(std::size_t i = 1; i < ids.size(); ++i){
+			EXPECT_LT(ids[i - 1], ids[i]) << "Non-monotonic at index " << i;
+			EXPECT_GE(ids[i].timestamp_ms(), 5000u);
+		}
+	}
+
+	TEST(Ulid, GeneratorMonotonicIncrementsRandomFieldByOne){
+		// Within one millisecond each ID is the previous one plus one, carrying from lo into hi.
+		ulid::generator gen{3};
+		auto first = gen.generate_monotonic(42);
+		for(int i = 0; i < 1000; ++i){
+			auto next = gen.generate_monotonic(42);
+			const auto [hi_a, lo_a] = first.to_uint64s();
+			const auto [hi_b, lo_b] = next.to_uint64s();
+			if(lo_a == ~0ull){
+				EXPECT_EQ(lo_b, 0u);
+				EXPECT_EQ(hi_b & 0xFFFF, (hi_a + 1) & 0xFFFF);
+			} else{
+				EXPECT_EQ(lo_b, lo_a + 1);
+				EXPECT_EQ(hi_b, hi_a);
+			}
+			first = next;
+		}
+	}
+
+	TEST(Ulid, RollbackReuseWrapsWhenRandomFieldIsExhausted){
+		ulid::basic_generator<AllOnes> gen{};
+		const auto a = gen.generate_monotonic(1000);
+		const auto b = gen.generate_monotonic(1000);
+		EXPECT_EQ(b, ulid_t::min_for_timestamp(1000)); // documented wrap, the reason the other policies exist
+		EXPECT_LT(b, a);
+	}
+
+	TEST(Ulid, RollbackBorrowFutureMovesToNextMillisecond){
+		ulid::basic_generator<AllOnes, ulid::system_ms_clock, ulid::rollback::borrow_future> gen{};
+		const auto a = gen.generate_monotonic(1000);
+		const auto b = gen.generate_monotonic(1000);
+		const auto c = gen.generate_monotonic(900); // behind and exhausted: borrows again
+		EXPECT_EQ(a.timestamp_ms(), 1000u);
+		EXPECT_EQ(b.timestamp_ms(), 1001u);
+		EXPECT_EQ(c.timestamp_ms(), 1002u);
+		EXPECT_LT(a, b);
+		EXPECT_LT(b, c);
+
+		ulid::basic_generator<RomuDuoJr, ulid::system_ms_clock, ulid::rollback::borrow_future> normal{7};
+		const auto d = normal.generate_monotonic(1000);
+		const auto e = normal.generate_monotonic(990); // room left: same as reuse
+		EXPECT_EQ(e.timestamp_ms(), 1000u);
+		EXPECT_LT(d, e);
+	}
+
+	TEST(Ulid, RollbackFailFastReturnsNullopt){
+		using gen_type = ulid::basic_generator<RomuDuoJr, ulid::system_ms_clock, ulid::rollback::fail_fast>;
+		static_assert(std::same_as<gen_type::monotonic_result, std::optional<ulid_t>>);
+		gen_type gen{7};
+		const auto a = gen.generate_monotonic(1000);
+		ASSERT_TRUE(a.has_value());
+		EXPECT_FALSE(gen.generate_monotonic(999).has_value());
+		const auto b = gen.generate_monotonic(1000); // the failure left the state alone
+		ASSERT_TRUE(b.has_value());
+		EXPECT_LT(*a, *b);
+		std::array<ulid_t, 4> out{};
+		EXPECT_EQ(gen.generate_monotonic_n(out, 1000), out.size());
+		EXPECT_EQ(gen.generate_monotonic_n(out, 998), 0u);
+
+		ulid::basic_generator<AllOnes, ulid::system_ms_clock, ulid::rollback::fail_fast> exhausted{};
+		ASSERT_TRUE(exhausted.generate_monotonic(1000).has_value());
+		EXPECT_FALSE(exhausted.generate_monotonic(1000).has_value());
+		EXPECT_TRUE(exhausted.generate_monotonic(1001).has_value());
+	}
+
+	TEST(Ulid, RollbackWaitsForTheClock){
+		ulid::basic_generator<RomuDuoJr, stepping_clock, ulid::rollback::wait> gen{7};
+		stepping_clock::next = 1000;
+		const auto a = gen.generate_monotonic();
+		stepping_clock::next = 990; // 10 ms rollback: reads 990, 991, ... until 1000
+		const auto b = gen.generate_monotonic();
+		EXPECT_EQ(b.timestamp_ms(), 1000u);
+		EXPECT_EQ(stepping_clock::next, 1001u);
+		EXPECT_LT(a, b);
+
+		ulid::basic_generator<AllOnes, stepping_clock, ulid::rollback::wait> exhausted{};
+		stepping_clock::next = 2000;
+		const auto c = exhausted.generate_monotonic();
+		stepping_clock::next = 2000; // same millisecond but no room: waits for 2001
+		const auto d = exhausted.generate_monotonic();
+		EXPECT_EQ(d.timestamp_ms(), 2001u);
+		EXPECT_LT(c, d);
+	}
+
+	TEST(Ulid, DefaultGeneratorsGetDistinctStreams){
+		std::vector<std::unique_ptr<ulid::generator>> pool; // heap-allocated, like a pool of worker threads' state
+		std::set<ulid_t> first_ids;
+		for(int i = 0; i < 512; ++i){
+			pool.push_back(std::make_unique<ulid::generator>());
+			first_ids.insert(pool.back()->generate(1000)); // same timestamp for all: only the stream differs
+		}
+		EXPECT_EQ(first_ids.size(), pool.size());
+
+		std::set<std::uint64_t> seeds;
+		for(int i = 0; i < 10000; ++i){
+			seeds.insert(ulid::seeding::next_seed());
+		}
+		EXPECT_EQ(seeds.size(), 10000u);
+		EXPECT_NE(ulid::seeding::os_entropy(), ulid::seeding::os_entropy());
+	}
+
+	TEST(Ulid, NodeGeneratorStampsEveryIdWithItsNode){
+		ulid::node_generator<8> a{ulid::node{200}, 7};
+		ulid::node_generator<8> b{ulid::node{201}, 7}; // same seed, different node: still disjoint
+		static_assert(decltype(a)::node_bits == 8);
+		ulid_t last{};
+		for(int i = 0; i < 1000; ++i){
+			const auto id = a.generate_monotonic(1000 + i / 300);
+			const auto other = b.generate_monotonic(1000 + i / 300);
+			EXPECT_EQ(id.node_id<8>(), 200u);
+			EXPECT_EQ(other.node_id<8>(), 201u);
+			EXPECT_EQ(a.generate(2000).node_id<8>(), 200u);
+			EXPECT_NE(id, other);
+			EXPECT_LT(last, id);
+			last = id;
+		}
+		constexpr auto routed = ulid::node_generator<16>{ulid::node{0xBEEF}, 1}.generate(5);
+		static_assert(routed.node_id<16>() == 0xBEEF && routed.node_id<4>() == 0xB);
+		EXPECT_EQ(ulid::node_generator<3>(ulid::node{9}, 1).generate(5).node_id<3>(), 1u) << "ids are taken modulo 2^NodeBits";
+	}
+
+	TEST(Ulid, NodeGeneratorIncrementNeverCarriesIntoNodeBits){
+		ulid::node_generator<8, AllOnes> wraps{ulid::node{0x5A}};
+		const auto full = wraps.generate_monotonic(1000);
+		EXPECT_EQ(full.to_uint64s().first & 0xFFFF, 0x5AFFu);
+		const auto wrapped = wraps.generate_monotonic(1000); // reuse: the 72 free bits wrap to zero
+		EXPECT_EQ(wrapped.to_uint64s(), (std::pair<std::uint64_t, std::uint64_t>{(std::uint64_t{1000} << 16) | 0x5A00u, 0}));
+
+		ulid::node_generator<8, AllOnes, ulid::system_ms_clock, ulid::rollback::borrow_future> borrows{ulid::node{0x5A}};
+		const auto c = borrows.generate_monotonic(1000);
+		const auto d = borrows.generate_monotonic(1000); // free bits full: next millisecond
+		EXPECT_EQ(d.timestamp_ms(), 1001u);
+		EXPECT_EQ(d.node_id<8>(), 0x5Au);
+		EXPECT_LT(c, d);
+	}
+
+	TEST(Ulid, ChaCha20MatchesRfc7539BlockVector){
+		// RFC 7539 2.3.2: key 00..1f, block counter 1, nonce 00:00:00:09:00:00:00:4a:00:00:00:00.
+		// The IETF layout splits our 64-bit counter / 64-bit nonce words differently, so the same
+		// 16 input words are written as counter = 0x09000000'00000001, nonce = 0x4a000000.
+		std::array<std::uint32_t, 8> key{};
+		for(std::uint32_t i = 0; i < 8; ++i){
+			key[i] = (4 * i) | ((4 * i + 1) << 8) | ((4 * i + 2) << 16) | ((4 * i + 3) << 24);
+		}
+		auto e = ChaCha20::from_key(key, 0x4a000000u, 0x0900000000000001ull);
+		constexpr std::array<std::uint64_t, 8> expected{
+			0x15593bd1e4e7f110ull, 0xc47120a31fdd0f50ull, 0x0368c033c7f4d1c7ull, 0x4e6cd4c39aaa2204ull,
+			0x09aa9f07466482d2ull, 0xa2028bd905d7c214ull, 0xb94e16ded19c12b5ull, 0x4e3c50a2e883d0cbull,
+		};
+		for(const auto word : expected){
+			EXPECT_EQ(e(), word);
+		}
+	}
+
+	TEST(Ulid, ChaCha20DiscardSplitAndConstexpr){
+		constexpr auto word_45 = []{ ChaCha20 e{3}; e.discard(45); return e(); }(); // portable path
+		ChaCha20 runtime{3}; // SIMD path, where available
+		runtime.discard(45);
+		EXPECT_EQ(runtime(), word_45);
+		ChaCha20 a{7};
+		ChaCha20 b{7};
+		EXPECT_EQ(a, b);
+		for(int i = 0; i < 1000; ++i){ (void)a(); }
+		b.discard(1000); // crosses several refills, some skipped by counter
+		EXPECT_EQ(a, b);
+		EXPECT_EQ(a(), b());
+		auto child = a.split();
+		EXPECT_NE(child, a);
+		EXPECT_NE(child(), a());
+	}
+
+	TEST(Ulid, SecureGeneratorKeysFromOsEntropy){
+		static_assert(ulid::seeding::keyed_engine<ChaCha20>);
+		static_assert(!ulid::seeding::keyed_engine<RomuDuoJr>);
+		ulid::secure_generator a{};
+		ulid::secure_generator b{};
+		EXPECT_NE(a.prng().engine(), b.prng().engine());
+		EXPECT_NE(a.generate(1000), b.generate(1000));
+		std::set<ulid_t> ids;
+		ulid_t last{};
+		for(int i = 0; i < 1000; ++i){
+			const auto id = a.generate_monotonic(1000 + i / 100);
+			EXPECT_LT(last, id);
+			last = id;
+			ids.insert(a.generate(2000));
+		}
+		EXPECT_EQ(ids.size(), 1000u);
+		const auto before = a.prng().engine();
+		a.reseed();
+		EXPECT_NE(a.prng().engine(), before);
+		EXPECT_LT(last, a.generate_monotonic(1009));
+	}
+
+	TEST(Ulid, ReseedStartsFreshMillisecondAndStaysMonotonic){
+		ulid::generator gen{42};
+		const auto a = gen.generate_monotonic(1000);
+		gen.reseed();
+		const auto b = gen.generate_monotonic(1000);
+		const auto c = gen.generate_monotonic(1001);
+		EXPECT_EQ(b.timestamp_ms(), 1001u); // not a continuation of a's suffix
+		EXPECT_LT(a, b);
+		EXPECT_LT(b, c);
+
+		const auto before = ulid::seeding::epoch();
+		const auto x = ulid_t::generate_monotonic();
+		ulid::seeding::reseed_after_fork();
+		EXPECT_EQ(ulid::seeding::epoch(), before + 1);
+		const auto y = ulid_t::generate_monotonic(); // thread-local generator noticed the new epoch
+		EXPECT_GT(y.timestamp_ms(), x.timestamp_ms()); // a fresh millisecond, at least one past x
+		EXPECT_LT(x, y);
+	}
+
+#if !defined(_WIN32)
+	TEST(Ulid, ForkedChildDoesNotRepeatParentIds){
+		(void)ulid_t::generate_monotonic();
+		int fds[2];
+		ASSERT_EQ(pipe(fds), 0);
+		const pid_t pid = fork();
+		ASSERT_GE(pid, 0);
+		if(pid == 0){
+			std::array<ulid_t, 64> ids{};
+			ulid::generator fresh{};
+			for(std::size_t i = 0; i < ids.size(); i += 2){
+				ids[i] = ulid_t::generate_monotonic();
+				ids[i + 1] = fresh.generate(1000);
+			}
+			const auto written = write(fds[1], ids.data(), sizeof(ids));
+			_exit(written == static_cast<ssize_t>(sizeof(ids)) ? 0 : 1);
+		}
+		close(fds[1]);
+		std::array<ulid_t, 64> parent{};
+		ulid::generator fresh{};
+		for(std::size_t i = 0; i < parent.size(); i += 2){
+			parent[i] = ulid_t::generate_monotonic();
+			parent[i + 1] = fresh.generate(1000);
+		}
+		std::array<ulid_t, 64> child{};
+		std::size_t got = 0;
+		while(got < sizeof(child)){
+			const auto n = read(fds[0], reinterpret_cast<char*>(child.data()) + got, sizeof(child) - got);
+			if(n <= 0){ break; }
+			got += static_cast<std::size_t>(n);
+		}
+		close(fds[0]);
+		int status = 0;
+		waitpid(pid, &status, 0);
+		ASSERT_EQ(got, sizeof(child));
+		ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+		const std::set<ulid_t> parent_set(parent.begin(), parent.end());
+		for(const auto& id : child){
+			EXPECT_FALSE(parent_set.contains(id)) << id;
+		}
+	}
+
+	TEST(Ulid, CachedClockKeepsTickingInForkedChild){
+		const auto start = ulid::cached_ms_clock::now_ms(); // ticker running in the parent
+		ASSERT_GT(start, 0u);
+		const pid_t pid = fork();
+		ASSERT_GE(pid, 0);
+		if(pid == 0){
+			const auto first = ulid::cached_ms_clock::now_ms();
+			std::this_thread::sleep_for(std::chrono::milliseconds{50});
+			const auto later = ulid::cached_ms_clock::now_ms();
+			_exit(first >= start && later >= first + 20 ? 0 : 1);
+		}
+		int status = 0;
+		waitpid(pid, &status, 0);
+		EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+	}
+#endif
+
+	TEST(Ulid, GeneratorWorksWith32BitEngine){
+		ulid::basic_generator<Xorshift32> gen{0xC0FFEEu};
+		std::set<ulid_t> unique;
+		std::array<ulid_t::byte, 10> seen{};
+		for(int i = 0; i < 256; ++i){
+			const auto id = gen.generate(1234);
+			unique.insert(id);
+			const auto bytes = id.to_bytes();
+			for(std::size_t b = 0; b < 10; ++b){
+				seen[b] |= bytes[6 + b];
+			}
+		}
+		EXPECT_EQ(unique.size(), 256u);
+		for(std::size_t b = 0; b < 10; ++b){
+			EXPECT_EQ(seen[b], 0xFF) << "random byte " << b;
+		}
+		for(int i = 0; i < 64; ++i){
+			const auto a = gen.generate_monotonic(77);
+			const auto b = gen.generate_monotonic(77);
+			EXPECT_LT(a, b);
+		}
+	}
+
 	TEST(Ulid, GenerateProducesMostlyUniqueIds){
 		constexpr int N = 2000;
 		std::set<std::string> s;
@@ -297,6 +785,24 @@ namespace {
 		EXPECT_EQ(oss.str(), expected);
 	}
 
+	TEST(Ulid, FormatterSpecs){
+		const auto id = *ulid_t::from_string("01ARZ3NDEKTSV4RRFFQ69G5FAV");
+
+		EXPECT_EQ(std::format("{}", id), "01ARZ3NDEKTSV4RRFFQ69G5FAV");
+		EXPECT_EQ(std::format("{:s}", id), "01ARZ3NDEKTSV4RRFFQ69G5FAV");
+		EXPECT_EQ(std::format("{:l}", id), "01arz3ndektsv4rrffq69g5fav");
+		EXPECT_EQ(std::format("{:r}", id), id.to_readable_string());
+		EXPECT_EQ(std::format("{:u}", id), "01563e3a-b5d3-d676-4c61-efb99302bd5b");
+		EXPECT_EQ(std::format("{:t}", id), std::to_string(id.timestamp_ms()));
+		EXPECT_EQ(std::format("[{}|{:t}]", ulid_t{}, ulid_t{}), "[00000000000000000000000000|0]");
+	}
+
+	TEST(Ulid, FormatterRejectsUnknownSpec){
+		const auto id = ulid_t::generate();
+		EXPECT_THROW((void)std::vformat("{:x}", std::make_format_args(id)), std::format_error);
+		EXPECT_THROW((void)std::vformat("{:ss}", std::make_format_args(id)), std::format_error);
+	}
+
 	TEST(Ulid, ExtractsTimestampFromBytes){
 		// 48-bit timestamp with a simple, recognisable byte pattern:
 		// ts = 0x00 01 02 03 04 05
@@ -446,6 +952,30 @@ namespace {
 		EXPECT_EQ(parsed, base);
 	}
 
+	TEST(Ulid, ReadableFormKnownDatesAndConstexpr){
+		constexpr auto id = ulid_t::from_uint64s(951782400123ull << 16, 0); // 2000-02-29 00:00:00.123, a leap day
+		constexpr auto chars = []{
+			std::array<char, 35> out{};
+			const auto id2 = ulid_t::from_uint64s(951782400123ull << 16, 0);
+			(void)id2.to_readable_chars(out.data(), out.data() + out.size());
+			return out;
+		}();
+		EXPECT_EQ(std::string_view(chars.data(), chars.size()), "20000229T000000123Z0000000000000000");
+		EXPECT_EQ(id.to_readable_string(), "20000229T000000123Z0000000000000000");
+		static_assert(ulid_t::from_readable_string("20000229T000000123Z0000000000000000") == id);
+		static_assert(!ulid_t::from_readable_string("19000229T000000000Z0000000000000000")); // 1900 was not a leap year
+		static_assert(!ulid_t::from_readable_string("19691231T235959999Z0000000000000000")); // before the epoch
+		static_assert(ulid_t::from_readable_string("19700101T000000000Z0000000000000000") == ulid_t{});
+		static_assert(ulid_t::from_readable_string("99991231T235959999ZZZZZZZZZZZZZZZZZ")->timestamp_ms() == 253402300799999ull);
+
+		std::array<char, 34> small{};
+		const auto result = id.to_readable_chars(small.data(), small.data() + small.size());
+		EXPECT_EQ(result.ec, std::errc::value_too_large);
+
+		// past year 9999 the year takes five digits, as std::format's %Y does
+		EXPECT_EQ(ulid_t::max_for_timestamp(ulid_t::MAX_TIMESTAMP).to_readable_string(), "108890802T053150655ZZZZZZZZZZZZZZZZZ");
+	}
+
 	TEST(Ulid, FromReadableStringRejectsOutOfRangeFields){
 		// Helper to make a readable string with a specific "YYYYMMDDThhmmssmmmZ"and a fixed random tail.
 		auto make_readable = [](std::string prefix){
@@ -599,5 +1129,970 @@ namespace {
 		EXPECT_EQ(id, id2);
 		EXPECT_TRUE(std::equal(raw.begin(), raw.end(), bytes2.begin()));
 	}
+
+	TEST(Ulid, ToCharsMatchesToString){
+		for(int i = 0; i < 100; ++i){
+			const auto id = ulid_t::generate();
+			const auto expected = id.to_string();
+
+			const auto arr = id.to_chars();
+			EXPECT_EQ(std::string(arr.data(), arr.size()), expected);
+
+			std::array<char, 26> fixed{};
+			id.to_chars(fixed);
+			EXPECT_EQ(fixed, arr);
+
+			char buf[32]{};
+			const auto rc = id.to_chars(std::begin(buf), std::end(buf));
+			ASSERT_EQ(rc.ec, std::errc{});
+			EXPECT_EQ(rc.ptr, buf + 26);
+			EXPECT_EQ(std::string(buf, rc.ptr), expected);
+		}
+	}
+
+	TEST(Ulid, ToCharsRejectsSmallBuffer){
+		const auto id = ulid_t::generate();
+		char buf[25]{};
+		const auto rc = id.to_chars(std::begin(buf), std::end(buf));
+		EXPECT_EQ(rc.ec, std::errc::value_too_large);
+		EXPECT_EQ(rc.ptr, std::end(buf));
+		EXPECT_EQ(buf[0], '\0'); // untouched
+	}
+
+	TEST(Ulid, ToCharsIsConstexpr){
+		constexpr auto chars = ulid_t::from_uint64s(0, 0).to_chars();
+		static_assert(chars[0] == '0' && chars[25] == '0');
+		EXPECT_EQ(std::string(chars.data(), chars.size()), std::string(26, '0'));
+	}
+
+	TEST(Ulid, FromStringAcceptsExactlyTheCrockfordAlphabet){
+		// Every byte value in the last position: valid iff it is a Crockford digit,
+		// its lowercase form, or one of the ambiguous letters O/o/I/i/L/l.
+		const std::string_view accepted = "0123456789ABCDEFGHJKMNPQRSTVWXYZabcdefghjkmnpqrstvwxyzOoIiLl";
+		std::string s(26, '0');
+		for(int c = 0; c < 256; ++c){
+			s[25] = static_cast<char>(c);
+			const bool expected = accepted.find(static_cast<char>(c)) != std::string_view::npos;
+			EXPECT_EQ(ulid_t::from_string(s).has_value(), expected) << "char code " << c;
+		}
+	}
+
+	TEST(Ulid, LiteralIsConstevalAndMatchesFromString){
+		using namespace ulid::literals;
+		constexpr ulid_t id = "01ARZ3NDEKTSV4RRFFQ69G5FAV"_ulid;
+		static_assert(id.to_uint64s() == std::pair<std::uint64_t, std::uint64_t>{0x01563E3AB5D3D676ull, 0x4C61EFB99302BD5Bull});
+		static_assert("01arz3ndektsv4rrffq69g5fav"_ulid == id);
+		static constexpr std::array<ulid_t, 3> table{
+			"00000000000000000000000000"_ulid,
+			"01ARZ3NDEKTSV4RRFFQ69G5FAV"_ulid,
+			"7ZZZZZZZZZZZZZZZZZZZZZZZZZ"_ulid,
+		};
+		static_assert(table[0] < table[1] && table[1] < table[2]);
+		EXPECT_EQ(table[1], ulid_t::from_string("01ARZ3NDEKTSV4RRFFQ69G5FAV"));
+		// "8ZZZZZZZZZZZZZZZZZZZZZZZZZ"_ulid or "01ARZ3NDEK"_ulid would not compile.
+	}
+
+	TEST(Ulid, FromStringIsConstexpr){
+		constexpr auto parsed = ulid_t::from_string("7ZZZZZZZZZZZZZZZZZZZZZZZZZ");
+		static_assert(parsed.has_value());
+		static_assert(parsed->to_uint64s().first == ~0ull && parsed->to_uint64s().second == ~0ull);
+		static_assert(!ulid_t::from_string("80000000000000000000000000").has_value());
+		EXPECT_EQ(parsed->to_string(), "7ZZZZZZZZZZZZZZZZZZZZZZZZZ");
+	}
+
+	TEST(UlidBatch, EncodeManyMatchesToStringOnEveryLevel){
+		std::vector<ulid_t> ids;
+		ids.push_back(ulid_t{});
+		ids.push_back(ulid_t::from_uint64s(~0ull, ~0ull));
+		ids.push_back(ulid_t::from_uint64s(0x0123456789ABCDEFull, 0xFEDCBA9876543210ull));
+		for(int i = 0; i < 97; ++i){ // odd count exercises the scalar tail
+			ids.push_back(ulid_t::generate());
+		}
+		for(auto level : {ulid::simd_level::scalar, ulid::simd_level::sse41, ulid::simd_level::avx2, ulid::simd_level::neon}){
+			if(!ulid::is_supported(level)){ continue; }
+			std::string out(ids.size() * 26, '?');
+			ASSERT_EQ(ulid::encode_many(ids, out, level), ids.size());
+			for(std::size_t i = 0; i < ids.size(); ++i){
+				EXPECT_EQ(out.substr(i * 26, 26), ids[i].to_string())
+					<< "level " << static_cast<int>(level) << ", index " << i;
+			}
+		}
+	}
+
+	TEST(UlidBatch, EncodeManyStopsAtOutputCapacity){
+		std::vector<ulid_t> ids(5, ulid_t::from_uint64s(1, 2));
+		std::string out(3 * 26 + 10, '?');
+		EXPECT_EQ(ulid::encode_many(ids, out), 3u);
+		EXPECT_EQ(out.substr(3 * 26), std::string(10, '?')); // nothing written past the last whole id
+	}
+
+	TEST(UlidBatch, EncodeManyNeverWritesPastTheIdsOnEveryLevel){
+		std::vector<ulid_t> ids(9, ulid_t::from_uint64s(1, 2));
+		for(auto level : {ulid::simd_level::scalar, ulid::simd_level::sse41, ulid::simd_level::avx2, ulid::simd_level::neon}){
+			if(!ulid::is_supported(level)){ continue; }
+			for(std::size_t n = 0; n <= ids.size(); ++n){ // odd and even counts end the vector loop differently
+				std::string out(ids.size() * 26 + 32, '#');
+				ASSERT_EQ(ulid::encode_many(std::span{ids}.first(n), out, level), n);
+				EXPECT_EQ(out.substr(n * 26), std::string(out.size() - n * 26, '#'))
+					<< "level " << static_cast<int>(level) << ", count " << n;
+			}
+		}
+	}
+
+	TEST(UlidBatch, DecodeManyMatchesFromStringForEveryCharAtEveryPosition){
+		// One record per (position, byte value) pair, so every level sees every char everywhere.
+		const std::string base = "01ARZ3NDEKTSV4RRFFQ69G5FAV";
+		std::string packed;
+		for(std::size_t pos = 0; pos < 26; ++pos){
+			for(int c = 0; c < 256; ++c){
+				std::string rec = base;
+				rec[pos] = static_cast<char>(c);
+				packed += rec;
+			}
+		}
+		const std::size_t n = packed.size() / 26;
+		for(auto level : {ulid::simd_level::scalar, ulid::simd_level::sse41, ulid::simd_level::avx2, ulid::simd_level::neon}){
+			if(!ulid::is_supported(level)){ continue; }
+			std::vector<ulid_t> out(n);
+			std::vector<std::uint64_t> bitmap((n + 63) / 64, ~0ull);
+			std::size_t expected_bad = 0;
+			const auto bad = ulid::decode_many(packed, out, bitmap, level);
+			for(std::size_t i = 0; i < n; ++i){
+				const auto expected = ulid_t::from_string(std::string_view{packed}.substr(i * 26, 26));
+				const bool flagged = ((bitmap[i / 64] >> (i % 64)) & 1u) != 0;
+				EXPECT_EQ(flagged, !expected.has_value()) << "level " << static_cast<int>(level) << ", record " << i;
+				EXPECT_EQ(out[i], expected.value_or(ulid_t{})) << "level " << static_cast<int>(level) << ", record " << i;
+				expected_bad += expected.has_value() ? 0 : 1;
+			}
+			EXPECT_EQ(bad, expected_bad);
+		}
+	}
+
+	TEST(UlidBatch, DecodeManyRoundtripsEncodeMany){
+		std::vector<ulid_t> ids(101);
+		for(auto& id : ids){
+			id = ulid_t::generate();
+		}
+		ids[0] = ulid_t::from_uint64s(~0ull, ~0ull);
+		std::string packed(ids.size() * 26, '\0');
+		ASSERT_EQ(ulid::encode_many(ids, packed), ids.size());
+
+		std::vector<ulid_t> decoded(ids.size());
+		EXPECT_EQ(ulid::decode_many(packed, decoded), 0u);
+		EXPECT_EQ(decoded, ids);
+	}
+
+	TEST(UlidShared, MonotonicWithinOneThreadIncludingRollback){
+		ulid::shared_generator gen;
+		std::vector<ulid_t> ids;
+		for(std::uint64_t ts : {100ull, 100ull, 101ull, 50ull, 101ull, 102ull}){
+			ids.push_back(gen.generate_monotonic(ts));
+		}
+		for(std::size_t i = 1; i < ids.size(); ++i){
+			EXPECT_LT(ids[i - 1], ids[i]) << "Non-monotonic at index " << i;
+		}
+		EXPECT_EQ(ids[3].timestamp_ms(), 101u); // rollback reuses the newest timestamp
+	}
+
+	TEST(UlidShared, UniqueAndPerThreadIncreasingAcrossThreads){
+		constexpr int THREADS = 8;
+		constexpr int PER_THREAD = 5000;
+		auto& gen = ulid::shared_generator::instance();
+		std::vector<std::vector<ulid_t>> results(THREADS);
+		{
+			std::vector<std::jthread> workers;
+			for(int t = 0; t < THREADS; ++t){
+				workers.emplace_back([&gen, &out = results[t]]{
+					out.reserve(PER_THREAD);
+					for(int i = 0; i < PER_THREAD; ++i){
+						out.push_back(gen.generate_monotonic());
+					}
+				});
+			}
+		}
+		std::vector<ulid_t> all;
+		for(const auto& r : results){
+			for(std::size_t i = 1; i < r.size(); ++i){
+				ASSERT_LT(r[i - 1], r[i]);
+			}
+			all.insert(all.end(), r.begin(), r.end());
+		}
+		std::sort(all.begin(), all.end());
+		EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end()) << "duplicate ULID across threads";
+	}
+
+	TEST(UlidShared, BlockGeneratorUniqueAndPerThreadIncreasing){
+		constexpr int THREADS = 8;
+		constexpr int PER_THREAD = 5000;
+		ulid::block_generator shared{7}; // tiny blocks, so threads keep coming back for more
+		std::vector<std::vector<ulid_t>> results(THREADS);
+		{
+			std::vector<std::jthread> workers;
+			for(int t = 0; t < THREADS; ++t){
+				workers.emplace_back([&shared, &out = results[t]]{
+					ulid::block_generator::local ids{shared};
+					for(int i = 0; i < PER_THREAD; ++i){
+						out.push_back(ids.generate());
+					}
+				});
+			}
+		}
+		std::vector<ulid_t> all;
+		for(const auto& r : results){
+			for(std::size_t i = 1; i < r.size(); ++i){
+				ASSERT_LT(r[i - 1], r[i]);
+			}
+			all.insert(all.end(), r.begin(), r.end());
+		}
+		std::sort(all.begin(), all.end());
+		EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end()) << "duplicate ULID across threads";
+	}
+
+	TEST(UlidShared, BlockGeneratorCountsThroughItsBlock){
+		ulid::block_generator shared{4};
+		ulid::block_generator::local a{shared};
+		ulid::block_generator::local b{shared};
+		const auto a0 = a.generate(1000);
+		const auto b0 = b.generate(1000); // b reserves the next block in the same millisecond
+		const auto a1 = a.generate(1000);
+		EXPECT_EQ(a1.to_uint64s().second, a0.to_uint64s().second + 1);
+		EXPECT_EQ(b0.to_uint64s().second, a0.to_uint64s().second + 4);
+		EXPECT_LT(a1, b0);
+
+		const auto a2 = a.generate(1001); // new millisecond: a leaves its block early
+		EXPECT_EQ(a2.timestamp_ms(), 1001u);
+		EXPECT_LT(b0, a2);
+	}
+
+	TEST(Ulid, NativeWordsKeepByteOrderAndOrdering){
+		constexpr std::array<ulid_t::byte, 16> bytes{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+			0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+		constexpr auto id = ulid_t::from_bytes(bytes);
+		static_assert(id.to_uint64s().first == 0x0123456789ABCDEFull);
+		static_assert(id.to_uint64s().second == 0xFEDCBA9876543210ull);
+		static_assert(id.to_bytes() == bytes);
+		static_assert(id.as_bytes() == bytes);
+		static_assert(id.timestamp_ms() == 0x0123456789ABull);
+
+		// hi decides before lo, exactly like comparing the 16 bytes left to right
+		static_assert(ulid_t::from_uint64s(1, 0) > ulid_t::from_uint64s(0, ~0ull));
+		static_assert(ulid_t::from_uint64s(1, 2) < ulid_t::from_uint64s(1, 3));
+		for(int i = 0; i < 1000; ++i){
+			const auto a = ulid_t::generate();
+			const auto b = ulid_t::generate();
+			EXPECT_EQ(a < b, a.to_bytes() < b.to_bytes());
+			EXPECT_EQ(a == b, a.to_bytes() == b.to_bytes());
+		}
+	}
+
+	TEST(Ulid, HasherMatchesAcrossUlidAndString){
+		const ulid::hasher h{};
+		for(int i = 0; i < 1000; ++i){
+			const auto id = ulid_t::generate();
+			const auto text = id.to_string();
+			EXPECT_EQ(h(id), h(std::string_view{text}));
+			EXPECT_EQ(h(id), std::hash<ulid_t>{}(id));
+		}
+		// lowercase and ambiguous letters decode to the same value, so they hash the same
+		constexpr std::string_view canonical = "01ARZ3NDEKTSV4RRFFQ69G5FA1";
+		constexpr std::string_view sloppy = "01arz3ndektsv4rrffq69g5fal";
+		static_assert(ulid::hasher{}(canonical) == ulid::hasher{}(sloppy));
+	}
+
+	TEST(Ulid, TransparentLookupByString){
+		std::unordered_map<ulid_t, int, ulid::hasher, ulid::equal_to> map;
+		std::vector<std::string> keys;
+		for(int i = 0; i < 100; ++i){
+			const auto id = ulid_t::generate();
+			map.emplace(id, i);
+			keys.push_back(id.to_string());
+		}
+		for(int i = 0; i < 100; ++i){
+			const auto it = map.find(std::string_view{keys[i]});
+			ASSERT_NE(it, map.end());
+			EXPECT_EQ(it->second, i);
+		}
+		EXPECT_EQ(map.find(std::string_view{"not a ulid"}), map.end());
+		EXPECT_EQ(map.find(std::string_view{"81ARZ3NDEKTSV4RRFFQ69G5FAV"}), map.end()); // overflows 128 bits
+	}
+
+	TEST(UlidFlatMap, MatchesUnorderedMapUnderInsertEraseChurn){
+		ulid::flat_map<std::uint64_t> flat;
+		std::unordered_map<ulid_t, std::uint64_t> reference;
+		std::vector<ulid_t> keys(2000);
+		ulid_t::generate_n(keys);
+		std::mt19937 rng{1234};
+		for(int round = 0; round < 20000; ++round){
+			const auto& key = keys[rng() % keys.size()];
+			if(rng() % 3 == 0){
+				EXPECT_EQ(flat.erase(key), reference.erase(key));
+			} else{
+				const auto value = static_cast<std::uint64_t>(round);
+				flat.insert_or_assign(key, value);
+				reference.insert_or_assign(key, value);
+			}
+		}
+		ASSERT_EQ(flat.size(), reference.size());
+		for(const auto& key : keys){
+			const auto it = flat.find(key);
+			const auto ref = reference.find(key);
+			ASSERT_EQ(it == flat.end(), ref == reference.end());
+			if(ref != reference.end()){
+				EXPECT_EQ(it.value(), ref->second);
+			}
+		}
+		std::size_t visited = 0;
+		for(const auto [key, value] : flat){
+			EXPECT_EQ(reference.at(key), value);
+			++visited;
+		}
+		EXPECT_EQ(visited, reference.size());
+	}
+
+	TEST(UlidFlatMap, InsertKeepsExistingAndSubscriptDefaults){
+		ulid::flat_map<int> map;
+		const auto a = ulid_t::generate();
+		EXPECT_TRUE(map.insert(a, 1).second);
+		EXPECT_FALSE(map.insert(a, 2).second);
+		EXPECT_EQ(map.find(a).value(), 1);
+		EXPECT_EQ(map[ulid_t::generate()], 0);
+		map[a] += 10;
+		EXPECT_EQ(map.find(a).value(), 11);
+		EXPECT_EQ(map.size(), 2u);
+
+		const auto copy = map;
+		map.clear();
+		EXPECT_TRUE(map.empty());
+		EXPECT_FALSE(map.contains(a));
+		EXPECT_TRUE(copy.contains(a));
+
+		map.reserve(1000);
+		const auto capacity = map.capacity();
+		std::vector<ulid_t> keys(1000);
+		ulid_t::generate_n(keys);
+		for(const auto& key : keys){ map.insert(key, 0); }
+		EXPECT_EQ(map.capacity(), capacity) << "reserve() should prevent rehashing";
+	}
+
+	struct throws_when_armed final{
+		static inline bool armed = false;
+		int value = 0;
+		throws_when_armed(){
+			if(armed){
+				armed = false;
+				throw std::bad_alloc{};
+			}
+		}
+		explicit throws_when_armed(int v) noexcept : value(v){}
+	};
+
+	TEST(UlidFlatMap, FailedGrowthKeepsEveryEntry){
+		ulid::flat_map<throws_when_armed> map;
+		std::vector<ulid_t> keys(200);
+		ulid_t::generate_n(keys);
+		std::size_t n = 0;
+		for(; n < keys.size(); ++n){ // insert until the next insert would have to grow the table
+			const auto capacity = map.capacity();
+			auto copy = map;
+			copy.insert(keys[n], throws_when_armed{0});
+			if(n > 0 && copy.capacity() != capacity){ break; }
+			map.insert(keys[n], throws_when_armed{static_cast<int>(n)});
+		}
+		ASSERT_LT(n, keys.size());
+		const auto capacity = map.capacity();
+		throws_when_armed::armed = true; // the new value array fails to construct
+		EXPECT_THROW((void)map.insert(keys[n], throws_when_armed{-1}), std::bad_alloc);
+		throws_when_armed::armed = false;
+		EXPECT_EQ(map.size(), n);
+		EXPECT_EQ(map.capacity(), capacity);
+		EXPECT_FALSE(map.contains(keys[n]));
+		for(std::size_t i = 0; i < n; ++i){
+			ASSERT_TRUE(map.contains(keys[i])) << i;
+			EXPECT_EQ(map.find(keys[i]).value().value, static_cast<int>(i));
+		}
+		EXPECT_TRUE(map.insert(keys[n], throws_when_armed{7}).second); // and it still grows afterwards
+		EXPECT_GT(map.capacity(), capacity);
+	}
+
+	TEST(UlidFlatMap, SetBasics){
+		ulid::flat_set set;
+		std::vector<ulid_t> keys(500);
+		ulid_t::generate_monotonic_n(keys);
+		for(const auto& key : keys){ EXPECT_TRUE(set.insert(key).second); }
+		for(const auto& key : keys){ EXPECT_FALSE(set.insert(key).second); }
+		EXPECT_EQ(set.size(), keys.size());
+		for(std::size_t i = 0; i < keys.size(); i += 2){ EXPECT_EQ(set.erase(keys[i]), 1u); }
+		for(std::size_t i = 0; i < keys.size(); ++i){ EXPECT_EQ(set.contains(keys[i]), i % 2 == 1); }
+		EXPECT_EQ(std::distance(set.begin(), set.end()), static_cast<std::ptrdiff_t>(keys.size() / 2));
+		EXPECT_EQ(set.memory_bytes(), set.capacity() * 17);
+	}
+
+	TEST(UlidAlgorithm, RadixSortMatchesStdSort){
+		std::mt19937_64 rng{42};
+		std::vector<ulid_t> ids(200000);
+		for(auto& id : ids){ // a few milliseconds, many duplicates of the timestamp bytes
+			id = ulid_t::from_uint64s(((1700000000000ull + rng() % 5) << 16) | (rng() & 0xFFFF), rng());
+		}
+		for(std::size_t i = 0; i < ids.size(); i += 97){
+			ids[i] = ids[i / 2]; // and some fully duplicated keys
+		}
+		auto expected = ids;
+		std::sort(expected.begin(), expected.end());
+
+		auto serial = ids;
+		ulid::sort(serial);
+		EXPECT_EQ(serial, expected);
+
+		for(unsigned threads : {2u, 3u, 8u}){
+			auto parallel = ids;
+			ulid::sort(parallel, threads);
+			EXPECT_EQ(parallel, expected) << threads << " threads";
+		}
+	}
+
+	TEST(UlidAlgorithm, RadixSortEdgeCases){
+		std::vector<ulid_t> empty;
+		ulid::sort(empty);
+		EXPECT_TRUE(empty.empty());
+
+		std::vector<ulid_t> same(1000, ulid_t::from_uint64s(7, 7));
+		ulid::sort(same);
+		EXPECT_TRUE(std::all_of(same.begin(), same.end(), [](const ulid_t& id){ return id == ulid_t::from_uint64s(7, 7); }));
+
+		// keys that differ only in the lowest byte, the last level the sort can reach
+		std::vector<ulid_t> low(300);
+		for(std::size_t i = 0; i < low.size(); ++i){
+			low[i] = ulid_t::from_uint64s(~0ull, 0xFF - (i % 256));
+		}
+		ulid::sort(low);
+		EXPECT_TRUE(std::is_sorted(low.begin(), low.end()));
+	}
+
+	TEST(Ulid, MinMaxForTimestamp){
+		constexpr auto lo = ulid_t::min_for_timestamp(1234);
+		constexpr auto hi = ulid_t::max_for_timestamp(1234);
+		static_assert(lo.timestamp_ms() == 1234 && hi.timestamp_ms() == 1234);
+		static_assert(lo < hi);
+		static_assert(ulid_t::max_for_timestamp(1233) < lo);
+		static_assert(hi < ulid_t::min_for_timestamp(1235));
+		static_assert(ulid_t::min_for_timestamp(~0ull).timestamp_ms() == ulid_t::MAX_TIMESTAMP);
+		EXPECT_EQ(lo.to_string(), "000000016J0000000000000000");
+		EXPECT_EQ(hi.to_string(), "000000016JZZZZZZZZZZZZZZZZ");
+	}
+
+	TEST(UlidAlgorithm, TimeRangeMatchesLowerBound){
+		std::mt19937_64 rng{7};
+		std::vector<ulid_t> ids(50000);
+		for(auto& id : ids){ // uneven on purpose: a dense cluster plus a long sparse tail
+			const std::uint64_t ts = rng() % 4 == 0 ? 1'000'000 + rng() % 10'000'000 : 1'000'000 + rng() % 1000;
+			id = ulid_t::from_uint64s((ts << 16) | (rng() & 0xFFFF), rng());
+		}
+		std::sort(ids.begin(), ids.end());
+		const std::span<const ulid_t> sorted{ids};
+		for(int i = 0; i < 2000; ++i){
+			std::uint64_t t0 = 999'000 + rng() % 11'100'000;
+			std::uint64_t t1 = t0 + rng() % (i % 2 ? 100 : 1'000'000);
+			const auto first = std::lower_bound(ids.begin(), ids.end(), ulid_t::min_for_timestamp(t0));
+			const auto last = std::upper_bound(ids.begin(), ids.end(), ulid_t::max_for_timestamp(t1));
+			const auto range = ulid::time_range(sorted, t0, t1);
+			ASSERT_EQ(range.data(), std::to_address(first));
+			ASSERT_EQ(range.size(), static_cast<std::size_t>(last - first));
+		}
+		EXPECT_TRUE(ulid::time_range(sorted, 10, 5).empty());
+		EXPECT_EQ(ulid::time_range(sorted, 0, ~0ull).size(), ids.size());
+		EXPECT_TRUE(ulid::time_range({}, 0, ~0ull).empty());
+	}
+
+	TEST(UlidAlgorithm, TimeBucketsPartitionTheSpan){
+		std::vector<ulid_t> ids;
+		for(std::uint64_t ts = 59'000; ts < 250'000; ts += 333){
+			ids.push_back(ulid_t::min_for_timestamp(ts));
+			ids.push_back(ulid_t::max_for_timestamp(ts));
+		}
+		std::size_t total = 0;
+		std::uint64_t previous = 0;
+		bool first = true;
+		ulid::for_each_time_bucket(ids, 60'000, [&](std::uint64_t start, std::span<const ulid_t> bucket){
+			EXPECT_EQ(start % 60'000, 0u);
+			EXPECT_TRUE(first || start > previous);
+			EXPECT_EQ(bucket.data(), ids.data() + total); // contiguous, no gaps
+			for(const auto& id : bucket){
+				EXPECT_EQ(id.timestamp_ms() - id.timestamp_ms() % 60'000, start);
+			}
+			total += bucket.size();
+			previous = start;
+			first = false;
+		});
+		EXPECT_EQ(total, ids.size());
+	}
+
+	TEST(UlidPack, RoundtripsInBothModes){
+		std::vector<ulid_t> random_ids(1000);
+		ulid_t::generate_n(random_ids);
+		random_ids[500] = ulid_t::from_uint64s(~0ull, ~0ull); // extremes, out of timestamp order
+		random_ids[501] = ulid_t{};
+		std::vector<ulid_t> monotonic(1000);
+		ulid_t::generate_monotonic_n(monotonic);
+
+		for(const auto* ids : {&random_ids, &monotonic}){
+			for(auto mode : {ulid::pack_mode::automatic, ulid::pack_mode::raw_random, ulid::pack_mode::delta_random}){
+				const auto packed = ulid::pack(*ids, mode);
+				EXPECT_LE(packed.size(), ulid::max_packed_size(ids->size()));
+				const auto unpacked = ulid::unpack(packed);
+				ASSERT_TRUE(unpacked.has_value());
+				EXPECT_EQ(*unpacked, *ids);
+			}
+		}
+		// one millisecond of monotonic IDs: about 2 bytes each instead of 16
+		EXPECT_LT(ulid::pack(monotonic).size(), monotonic.size() * 3);
+		EXPECT_LT(ulid::pack(random_ids).size(), random_ids.size() * 13);
+
+		const auto empty = ulid::pack(std::span<const ulid_t>{});
+		ASSERT_TRUE(ulid::unpack(empty).has_value());
+		EXPECT_TRUE(ulid::unpack(empty)->empty());
+	}
+
+	TEST(UlidPack, UnpackIntoCallerBufferAndRejectBadInput){
+		std::vector<ulid_t> ids(64);
+		ulid_t::generate_monotonic_n(ids);
+		const auto packed = ulid::pack(ids);
+
+		std::array<ulid_t, 64> out{};
+		ASSERT_EQ(ulid::unpack(packed, out), 64u);
+		EXPECT_TRUE(std::equal(out.begin(), out.end(), ids.begin()));
+		std::array<ulid_t, 63> small{};
+		EXPECT_FALSE(ulid::unpack(packed, small).has_value());
+
+		for(std::size_t n = 0; n < packed.size(); ++n){ // every truncation fails cleanly
+			EXPECT_FALSE(ulid::unpack(std::span{packed}.first(n)).has_value()) << n;
+		}
+		auto trailing = packed;
+		trailing.push_back(std::byte{0});
+		EXPECT_FALSE(ulid::unpack(trailing).has_value());
+		auto bad_magic = packed;
+		bad_magic[0] = std::byte{'X'};
+		EXPECT_FALSE(ulid::unpack(bad_magic).has_value());
+
+		std::vector<std::byte> too_small(ulid::max_packed_size(ids.size()) - 1);
+		EXPECT_FALSE(ulid::pack(ids, too_small).has_value());
+	}
+
+	TEST(UlidFile, WriteMapAndQuery){
+		std::mt19937_64 rng{99};
+		std::vector<ulid_t> ids(20000);
+		for(auto& id : ids){
+			id = ulid_t::from_uint64s(((1'000'000 + rng() % 100'000) << 16) | (rng() & 0xFFFF), rng());
+		}
+		std::sort(ids.begin(), ids.end());
+		const auto path = std::filesystem::temp_directory_path() / "cpp_ulid_test.ulids";
+		for(std::size_t stride : {std::size_t{0}, std::size_t{1}, std::size_t{64}, std::size_t{4096}}){
+			ASSERT_TRUE(ulid::write_sorted_file(path, ids, stride));
+			const auto file = ulid::mapped_file::open(path);
+			ASSERT_TRUE(file.has_value());
+			ASSERT_EQ(file->size(), ids.size());
+			EXPECT_TRUE(std::equal(ids.begin(), ids.end(), file->ids().begin()));
+			EXPECT_EQ(file->index().size(), stride == 0 ? 0 : (ids.size() + stride - 1) / stride);
+			for(int i = 0; i < 200; ++i){
+				const std::uint64_t t0 = 999'000 + rng() % 102'000;
+				const std::uint64_t t1 = t0 + rng() % 500;
+				const auto expected = ulid::time_range(ids, t0, t1);
+				const auto range = file->time_range(t0, t1);
+				ASSERT_EQ(range.size(), expected.size());
+				ASSERT_EQ(range.data() - file->ids().data(), expected.data() - ids.data());
+			}
+			EXPECT_TRUE(file->contains(ids[1234]));
+			EXPECT_FALSE(file->contains(ulid_t::from_uint64s(42, 42)));
+		}
+		std::filesystem::remove(path);
+	}
+
+	TEST(UlidFile, RejectsBadFiles){
+		const auto path = std::filesystem::temp_directory_path() / "cpp_ulid_test_bad.ulids";
+		std::vector<ulid_t> unsorted{ulid_t::from_uint64s(2, 0), ulid_t::from_uint64s(1, 0)};
+		EXPECT_FALSE(ulid::write_sorted_file(path, unsorted));
+
+		std::vector<ulid_t> ids(100);
+		ulid_t::generate_monotonic_n(ids);
+		ASSERT_TRUE(ulid::write_sorted_file(path, ids, 10));
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1); // truncated index
+		EXPECT_FALSE(ulid::mapped_file::open(path).has_value());
+		std::filesystem::resize_file(path, 10); // not even a header
+		EXPECT_FALSE(ulid::mapped_file::open(path).has_value());
+		EXPECT_FALSE(ulid::mapped_file::open(path.string() + ".missing").has_value());
+
+		ASSERT_TRUE(ulid::write_sorted_file(path, {}));
+		const auto empty = ulid::mapped_file::open(path);
+		ASSERT_TRUE(empty.has_value());
+		EXPECT_TRUE(empty->empty());
+		EXPECT_TRUE(empty->time_range(0, ~0ull).empty());
+		std::filesystem::remove(path);
+	}
+
+	TEST(UlidStream, ParsesRecordsSplitAcrossAnyChunking){
+		std::vector<ulid_t> ids(300);
+		ulid_t::generate_n(ids);
+		std::string text;
+		std::vector<std::pair<ulid_t, std::string>> expected;
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			std::string line = i % 3 == 0 ? ids[i].to_readable_string() : ids[i].to_string();
+			if(i % 5 == 0){ line += ",level=info,msg=hello"; }
+			if(i % 7 == 0){ line += '\r'; }
+			text += line + '\n';
+			if(line.back() == '\r'){ line.pop_back(); }
+			expected.emplace_back(ids[i], line);
+			if(i % 11 == 0){ text += "garbage line\n\n"; } // one invalid, one empty
+		}
+		text += ids[0].to_string(); // no trailing newline
+		expected.emplace_back(ids[0], ids[0].to_string());
+
+		std::mt19937 rng{5};
+		for(std::size_t max_chunk : {std::size_t{1}, std::size_t{7}, std::size_t{40}, std::size_t{4096}, text.size()}){
+			ulid::stream_parser parser{};
+			std::vector<std::pair<ulid_t, std::string>> got;
+			auto sink = [&](const ulid_t& id, std::string_view line){ got.emplace_back(id, std::string{line}); };
+			for(std::size_t pos = 0; pos < text.size();){
+				const std::size_t n = std::min<std::size_t>(text.size() - pos, 1 + rng() % max_chunk);
+				parser.feed(std::span{text}.subspan(pos, n), sink);
+				pos += n;
+			}
+			parser.finish(sink);
+			ASSERT_EQ(got, expected) << "max chunk " << max_chunk;
+			EXPECT_EQ(parser.records(), expected.size());
+			EXPECT_EQ(parser.invalid(), (ids.size() + 10) / 11);
+		}
+	}
+
+	TEST(UlidStream, RejectsMalformedFirstFields){
+		ulid::stream_parser parser{};
+		std::size_t accepted = 0;
+		const std::string_view text =
+			"01ARZ3NDEKTSV4RRFFQ69G5FAV\n"			// ok
+			"01ARZ3NDEKTSV4RRFFQ69G5FA\n"			// 25 chars
+			"01ARZ3NDEKTSV4RRFFQ69G5FAVX\n"		// 27 chars
+			"81ARZ3NDEKTSV4RRFFQ69G5FAV\n"			// overflow
+			"01ARZ3NDEKTSV4RRFFQ69G5FAU\tfield\n"	// U is not Crockford
+			"20250101T000000000ZZZZZZZZZZZZZZZZZ\n"// ok, readable
+			"20251301T000000000ZZZZZZZZZZZZZZZZZ\n";// month 13
+		parser.feed(std::span{text}, [&](const ulid_t&, std::string_view){ ++accepted; });
+		parser.finish([&](const ulid_t&, std::string_view){ ++accepted; });
+		EXPECT_EQ(accepted, 2u);
+		EXPECT_EQ(parser.invalid(), 5u);
+	}
+
+	// Built both ways by CMake: cpp_ulid_tests (off) and cpp_ulid_tests_instrumented (ULID_INSTRUMENTATION=1).
+	TEST(UlidMetrics, DisabledSnapshotIsEmpty){
+		if constexpr(ulid::metrics::enabled){
+			GTEST_SKIP() << "instrumented build";
+		}
+		(void)ulid_t::generate_monotonic();
+		(void)ulid_t::from_string("nope");
+		const auto m = ulid::metrics::snapshot();
+		EXPECT_EQ(m.generated, 0u);
+		EXPECT_EQ(m.rejected_by(ulid::metrics::reject::length), 0u);
+		EXPECT_EQ(m.suffix_headroom_min_bits, 80u);
+	}
+
+	TEST(UlidMetrics, CountsGenerationIncrementsAndRegressions){
+		if constexpr(!ulid::metrics::enabled){
+			GTEST_SKIP() << "build with ULID_INSTRUMENTATION=1";
+		}
+		ulid::generator gen{42};
+		const auto before = ulid::metrics::snapshot();
+		(void)gen.generate(5);
+		(void)gen.generate_monotonic(1000);
+		(void)gen.generate_monotonic(1000);	// same millisecond
+		(void)gen.generate_monotonic(990);	// 10 ms back
+		(void)gen.generate_monotonic(700);	// 300 ms back
+		(void)gen.generate_monotonic(1001);
+		const auto after = ulid::metrics::snapshot();
+		EXPECT_EQ(after.generated - before.generated, 6u);
+		EXPECT_EQ(after.monotonic_increments - before.monotonic_increments, 3u);
+		EXPECT_EQ(after.clock_regressions - before.clock_regressions, 2u);
+		EXPECT_EQ(after.clock_regression_total_ms - before.clock_regression_total_ms, 310u);
+		EXPECT_GE(after.clock_regression_max_ms, 300u);
+		EXPECT_LE(after.suffix_headroom_min_bits, 80u);
+		EXPECT_EQ(after.suffix_overflows, before.suffix_overflows);
+	}
+
+	TEST(UlidMetrics, CountsParseRejectionsByReason){
+		if constexpr(!ulid::metrics::enabled){
+			GTEST_SKIP() << "build with ULID_INSTRUMENTATION=1";
+		}
+		using ulid::metrics::reject;
+		const auto before = ulid::metrics::snapshot();
+		(void)ulid_t::from_string("01ARZ3NDEK");
+		(void)ulid_t::from_string("01ARZ3NDEKTSV4RRFFQ69G5FAU");
+		(void)ulid_t::from_string("81ARZ3NDEKTSV4RRFFQ69G5FAV");
+		(void)ulid_t::from_string("01ARZ3NDEKTSV4RRFFQ69G5FAV"); // valid, not counted
+		(void)ulid_t::from_readable_string("20240101T000000000Z");
+		(void)ulid_t::from_readable_string("20240230T000000000ZTSV4RRFFQ69G5FAV");
+		(void)ulid_t::from_readable_string("20240101T000000000ZTSV4RRFFQ69G5FAU");
+		(void)ulid_t::from_uuid_string("01890a5d-ac96-774b-bcce-b302099a8057x");
+		const auto after = ulid::metrics::snapshot();
+		for(const auto r : {reject::length, reject::character, reject::overflow, reject::readable_shape, reject::readable_field, reject::readable_random, reject::uuid}){
+			EXPECT_EQ(after.rejected_by(r) - before.rejected_by(r), 1u) << static_cast<int>(r);
+		}
+	}
+
+	TEST(UlidMetrics, DecodeManyCountsTheSameRejectionsOnEveryLevel){
+		if constexpr(!ulid::metrics::enabled){
+			GTEST_SKIP() << "build with ULID_INSTRUMENTATION=1";
+		}
+		using ulid::metrics::reject;
+		const std::string packed =
+			"01ARZ3NDEKTSV4RRFFQ69G5FAV"
+			"01ARZ3NDEKTSV4RRFFQ69G5FAU"	// character
+			"81ARZ3NDEKTSV4RRFFQ69G5FAV"	// overflow
+			"01ARZ3NDEKTSV4RRFFQ69G5FA!";	// character
+		for(auto level : {ulid::simd_level::scalar, ulid::simd_level::sse41, ulid::simd_level::avx2, ulid::simd_level::neon}){
+			if(!ulid::is_supported(level)){ continue; }
+			std::vector<ulid_t> out(4);
+			const auto before = ulid::metrics::snapshot();
+			EXPECT_EQ(ulid::decode_many(packed, out, {}, level), 3u);
+			const auto after = ulid::metrics::snapshot();
+			EXPECT_EQ(after.rejected_by(reject::character) - before.rejected_by(reject::character), 2u) << "level " << static_cast<int>(level);
+			EXPECT_EQ(after.rejected_by(reject::overflow) - before.rejected_by(reject::overflow), 1u) << "level " << static_cast<int>(level);
+		}
+	}
+
+	TEST(UlidMetrics, SharedGeneratorCountsEachIdOnceUnderContention){
+		if constexpr(!ulid::metrics::enabled){
+			GTEST_SKIP() << "build with ULID_INSTRUMENTATION=1";
+		}
+		ulid::shared_generator gen;
+		constexpr std::uint64_t per_thread = 20000;
+		const auto before = ulid::metrics::snapshot();
+		{
+			std::vector<std::jthread> threads;
+			for(int t = 0; t < 4; ++t){
+				threads.emplace_back([&gen]{
+					for(std::uint64_t i = 0; i < per_thread; ++i){
+						(void)gen.generate_monotonic(1000 + i / 4); // threads race for each new millisecond
+					}
+				});
+			}
+		}
+		EXPECT_EQ(ulid::metrics::snapshot().generated - before.generated, 4 * per_thread);
+	}
+
+	TEST(UlidMetrics, NodeGeneratorHeadroomCountsOnlyTheFreeBits){
+		if constexpr(!ulid::metrics::enabled){
+			GTEST_SKIP() << "build with ULID_INSTRUMENTATION=1";
+		}
+		ulid::node_generator<8, NearlyFull> gen{ulid::node{0x5A}};
+		const auto before = ulid::metrics::snapshot();
+		ASSERT_GT(before.suffix_headroom_min_bits, 0u);
+		(void)gen.generate_monotonic(1000); // free field: all ones but the last bit
+		const auto full = gen.generate_monotonic(1000); // now all ones; the node bits below 0x5A are not room
+		EXPECT_EQ(full.to_uint64s().second, ~0ull);
+		const auto at_full = ulid::metrics::snapshot();
+		EXPECT_EQ(at_full.suffix_headroom_min_bits, 0u);
+		EXPECT_EQ(at_full.suffix_overflows, before.suffix_overflows);
+		const auto wrapped = gen.generate_monotonic(1000); // the 72 free bits wrap
+		EXPECT_EQ(wrapped.node_id<8>(), 0x5Au);
+		EXPECT_EQ(ulid::metrics::snapshot().suffix_overflows - before.suffix_overflows, 1u);
+	}
+
+	TEST(UlidMetrics, KeepsCountsFromExitedThreads){
+		if constexpr(!ulid::metrics::enabled){
+			GTEST_SKIP() << "build with ULID_INSTRUMENTATION=1";
+		}
+		const auto before = ulid::metrics::snapshot();
+		std::jthread{[]{
+			for(int i = 0; i < 10; ++i){
+				(void)ulid_t::generate();
+			}
+		}}.join();
+		EXPECT_EQ(ulid::metrics::snapshot().generated - before.generated, 10u);
+	}
+
+	struct manual_clock final{
+		static inline std::uint64_t now = 0;
+		static std::uint64_t now_ms() noexcept{ return now; }
+	};
+	using manual_pool = ulid::basic_prefetch_pool<RomuDuoJr, manual_clock>;
+
+	TEST(UlidPool, ManualRefillHandsOutIdsInRingOrder){
+		manual_clock::now = 1000;
+		manual_pool pool{{.capacity = 100, .max_age_ms = 5, .mode = ulid::refill_mode::manual}};
+		EXPECT_EQ(pool.capacity(), 128u);
+		EXPECT_EQ(pool.size(), 128u); // filled on construction
+		ulid_t last{};
+		for(int i = 0; i < 50; ++i){
+			const auto id = pool.try_pop();
+			ASSERT_TRUE(id);
+			EXPECT_LT(last, *id);
+			last = *id;
+		}
+		EXPECT_EQ(pool.refill(), 50u);
+		for(int i = 0; i < 128; ++i){
+			const auto id = pool.try_pop();
+			ASSERT_TRUE(id);
+			EXPECT_LT(last, *id);
+			last = *id;
+		}
+		EXPECT_FALSE(pool.try_pop());
+		EXPECT_GE(pool.pop().timestamp_ms(), 1000u); // falls back to the thread-local generator
+	}
+
+	TEST(UlidPool, NeverHandsOutIdsOlderThanMaxAge){
+		manual_clock::now = 2000;
+		manual_pool pool{{.capacity = 64, .max_age_ms = 5, .mode = ulid::refill_mode::manual}};
+		manual_clock::now = 2005; // exactly max_age old: still fresh
+		const auto fresh = pool.try_pop();
+		ASSERT_TRUE(fresh);
+		EXPECT_EQ(fresh->timestamp_ms(), 2000u);
+		manual_clock::now = 2006;
+		EXPECT_FALSE(pool.try_pop()); // drops all 63 on the way
+		EXPECT_EQ(pool.size(), 0u);
+		EXPECT_GE(pool.pop().timestamp_ms(), 2006u);
+
+		pool.refill();
+		manual_clock::now = 2020;
+		EXPECT_EQ(pool.refill(), 64u); // the ring was full, but all stale: every ID is replaced
+		EXPECT_EQ(pool.size(), 64u);
+		const auto replaced = pool.try_pop();
+		ASSERT_TRUE(replaced);
+		EXPECT_EQ(replaced->timestamp_ms(), 2020u);
+		EXPECT_LT(*fresh, *replaced);
+	}
+
+	TEST(UlidPool, BackgroundRefillServesManyThreadsUniquely){
+		ulid::prefetch_pool pool{{.capacity = 1024, .max_age_ms = 50}};
+		constexpr int THREADS = 4;
+		constexpr int PER_THREAD = 5000;
+		std::vector<std::vector<ulid_t>> popped(THREADS);
+		std::vector<std::thread> threads;
+		for(int t = 0; t < THREADS; ++t){
+			threads.emplace_back([&pool, &out = popped[t]]{
+				while(out.size() < PER_THREAD){
+					if(const auto id = pool.try_pop()){
+						out.push_back(*id);
+					} else{
+						std::this_thread::yield(); // wait for the producer
+					}
+				}
+			});
+		}
+		for(auto& t : threads){ t.join(); }
+		std::set<ulid_t> all;
+		for(const auto& ids : popped){
+			EXPECT_TRUE(std::is_sorted(ids.begin(), ids.end())); // pops follow ring order
+			all.insert(ids.begin(), ids.end());
+		}
+		EXPECT_EQ(all.size(), static_cast<std::size_t>(THREADS * PER_THREAD));
+	}
+
+	TEST(UlidWire, WriteToAndReadFromMatchAsBytesAtAnyAlignment){
+		constexpr auto id = ulid_t::from_uint64s(0x0123456789ABCDEFull, 0xFEDCBA9876543210ull);
+		static_assert([id]{
+			std::array<std::byte, 16> buf{};
+			return id.write_to(buf) && ulid_t::read_from(buf) == id && buf[0] == std::byte{0x01} && buf[15] == std::byte{0x10};
+		}());
+		std::array<std::byte, 40> buf{};
+		const auto expected = id.as_bytes();
+		for(std::size_t offset = 0; offset < 8; ++offset){
+			const auto out = std::span{buf}.subspan(offset);
+			ASSERT_TRUE(id.write_to(out));
+			EXPECT_EQ(std::memcmp(out.data(), expected.data(), 16), 0);
+			EXPECT_EQ(ulid_t::read_from(out), id);
+		}
+		EXPECT_FALSE(id.write_to(std::span{buf}.first(15)));
+		EXPECT_FALSE(ulid_t::read_from(std::span{buf}.first(15)));
+	}
+
+	TEST(UlidWire, ScatterAndGatherMatchThePackedStream){
+		ulid::generator gen{11};
+		std::vector<ulid_t> ids(20);
+		gen.generate_monotonic_n(ids, 1000);
+		std::vector<std::byte> packed(ids.size() * 16 + 5);
+		EXPECT_EQ(ulid::write_many(ids, packed), ids.size());
+		std::vector<ulid_t> back(ids.size() + 3);
+		EXPECT_EQ(ulid::read_many(packed, back), ids.size()); // the 5 spare bytes are not an ID
+		EXPECT_TRUE(std::equal(ids.begin(), ids.end(), back.begin()));
+
+		// Uneven slices: IDs straddle boundaries, one slice is empty, one is shorter than an ID.
+		std::vector<std::byte> scattered(ids.size() * 16);
+		const std::size_t cuts[] = {0, 7, 7, 40, 45, 100, 250, scattered.size() - 1};
+		std::vector<std::span<std::byte>> slices;
+		for(std::size_t i = 0; i + 1 < std::size(cuts); ++i){
+			slices.push_back(std::span{scattered}.subspan(cuts[i], cuts[i + 1] - cuts[i]));
+		}
+		EXPECT_EQ(ulid::write_scatter(ids, slices), ids.size() - 1); // one byte short of the last
+		EXPECT_EQ(std::memcmp(scattered.data(), packed.data(), (ids.size() - 1) * 16), 0);
+		std::vector<ulid_t> gathered(ids.size());
+		EXPECT_EQ(ulid::read_gather(slices, gathered), ids.size() - 1);
+		EXPECT_TRUE(std::equal(ids.begin(), ids.end() - 1, gathered.begin()));
+#if !defined(_WIN32)
+		std::vector<std::byte> frame(ids.size() * 16);
+		const std::array<iovec, 3> iov{{{frame.data(), 3}, {frame.data() + 3, 200}, {frame.data() + 203, frame.size() - 203}}};
+		EXPECT_EQ(ulid::write_scatter(ids, iov), ids.size());
+		EXPECT_EQ(std::memcmp(frame.data(), packed.data(), frame.size()), 0);
+		std::vector<ulid_t> from_iov(ids.size());
+		EXPECT_EQ(ulid::read_gather(iov, from_iov), ids.size());
+		EXPECT_EQ(from_iov, ids);
+#endif
+	}
+
+	TEST(UlidUuid, CharsMatchHexOfBytesAndRoundtrip){
+		constexpr auto id = ulid_t::from_uint64s(0x01890A5DAC96774Bull, 0xBCCEB302099A8057ull);
+		constexpr auto text = id.to_uuid_chars();
+		static_assert(std::string_view(text.data(), text.size()) == "01890a5d-ac96-774b-bcce-b302099a8057");
+		static_assert(ulid_t::from_uuid_string("01890A5D-AC96-774B-BCCE-B302099A8057") == id);
+		EXPECT_EQ(id.to_uuid_string(), "01890a5d-ac96-774b-bcce-b302099a8057");
+		EXPECT_EQ(std::format("{:u}", id), id.to_uuid_string());
+
+		constexpr char HEX[] = "0123456789abcdef";
+		std::mt19937_64 rng{5};
+		for(int n = 0; n < 2000; ++n){
+			const auto x = ulid_t::from_uint64s(rng(), rng());
+			std::string expected;
+			const auto bytes = x.to_bytes();
+			for(std::size_t i = 0; i < bytes.size(); ++i){
+				if(i == 4 || i == 6 || i == 8 || i == 10){ expected += '-'; }
+				expected += HEX[bytes[i] >> 4];
+				expected += HEX[bytes[i] & 0xF];
+			}
+			ASSERT_EQ(x.to_uuid_string(), expected);
+			ASSERT_EQ(ulid_t::from_uuid_string(expected), x);
+		}
+		std::array<char, 35> small{};
+		EXPECT_EQ(id.to_uuid_chars(small.data(), small.data() + small.size()).ec, std::errc::value_too_large);
+	}
+
+	TEST(UlidUuid, RejectsEveryNonHexCharAtEveryDigit){
+		const std::string good = "01890a5d-ac96-774b-bcce-b302099a8057";
+		for(std::size_t pos = 0; pos < good.size(); ++pos){
+			for(int c = 0; c < 256; ++c){
+				std::string s = good;
+				s[pos] = static_cast<char>(c);
+				const bool dash_slot = pos == 8 || pos == 13 || pos == 18 || pos == 23;
+				const bool valid = dash_slot ? c == '-' : std::isxdigit(c) != 0;
+				ASSERT_EQ(ulid_t::from_uuid_string(s).has_value(), valid) << pos << ' ' << c;
+			}
+		}
+		EXPECT_FALSE(ulid_t::from_uuid_string(good.substr(1)));
+		EXPECT_FALSE(ulid_t::from_uuid_string(good + "0"));
+		EXPECT_FALSE(ulid_t::from_uuid_string("01890a5dac96774bbcceb302099a8057"));
+	}
+
+	TEST(UlidUuid, UuidV7KeepsTimestampAndIsStableOnceStamped){
+		ulid::generator gen{3};
+		ulid_t last_v7{};
+		for(int i = 0; i < 1000; ++i){
+			const auto id = gen.generate_monotonic(1'700'000'000'000 + i / 100);
+			const auto v7 = id.to_uuid_v7();
+			const auto text = v7.to_uuid_string();
+			EXPECT_EQ(text[14], '7');									// version
+			EXPECT_NE(std::string_view("89ab").find(text[19]), std::string_view::npos);	// variant 10
+			EXPECT_TRUE(v7.is_uuid_v7());
+			EXPECT_EQ(v7.timestamp_ms(), id.timestamp_ms());
+			EXPECT_EQ(v7.to_uuid_v7(), v7);								// lossless once stamped
+			EXPECT_EQ(ulid_t::from_uuid_string(text), v7);					// and a valid ULID as is
+			EXPECT_LT(last_v7, v7);										// monotonic runs stay ordered
+			last_v7 = v7;
+		}
+		EXPECT_FALSE(ulid_t::from_uint64s(0, 0).is_uuid_v7());
+	}
 } // namespace
 
@@ -1,7 +1,10 @@
 #pragma once
 #include "random.hpp" //grab from: https://github.com/ulfben/cpp_prngs/
 #include "romuduojr.hpp" //grab from: https://github.com/ulfben/cpp_prngs/
+#include "chacha20.hpp"
+#include "ulid_metrics.hpp"
 #include <array>
+#include <bit>
 #include <chrono>
 #include <cstdint>
 #include <optional>
@@ -9,8 +12,35 @@
 #include <span>
 #include <string>
 #include <string_view>
-#include <format>
 #include <charconv>
+#include <cstring>
+#include <format>
+#include <atomic>
+#include <concepts>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <time.h>
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <bcrypt.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "bcrypt")
+#endif
+#else
+#include <pthread.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#else
+#include <stdlib.h> // arc4random_buf
+#endif
+#endif
 
 // cpp_ulid - A small header-only C++23 library for generating, parsing,
 // and manipulating ULIDs (Universally Unique Lexicographically Sortable
@@ -44,46 +74,129 @@
 //       increasing values within a thread, even with clock rollback or
 //       multiple IDs within the same millisecond.
 //
+//   - ulid_t::generate_n(span<ulid_t>), ulid_t::generate_monotonic_n(span<ulid_t>)
+//       Bulk versions of the above. Read the clock once per batch and fill the
+//       random field with whole 64-bit PRNG outputs.
+//
 //   - ulid_t::from_string(string_view)
 //       Parse a 26-character canonical Crockford Base32 ULID.
 //       Accepts lowercase and ambiguous input; returns std::nullopt on error.
 //
+//   - "01ARZ3NDEKTSV4RRFFQ69G5FAV"_ulid (using namespace ulid::literals)
+//       consteval literal: no startup parsing, and malformed input fails to compile.
+//
 //   - ulid_t::from_readable_string(string_view)
 //       Parse the non-standard 35-character human-readable form
 //       "YYYYMMDDThhmmssmmmZxxxxxxxxxxxxxxxx".
 //       Preserves millisecond precision and lexical sort order.
 //
+//   - ulid_t::from_uuid_string(string_view)
+//       Parse canonical 36-char UUID text (8-4-4-4-12 hex, either case) as the same 128 bits.
+//
 //   - ulid_t::from_bytes(span<const byte,16>)
 //       Construct a ULID directly from its 16-byte big-endian form.
 //
+//   - ulid_t::read_from(span<const std::byte>) -> optional<ulid_t>
+//       The same 16 bytes read from the front of any wire buffer, unaligned, with no copy;
+//       std::nullopt if the buffer is shorter. ulid_wire.hpp has the batch and iovec forms.
+//
 //   - ulid_t::from_uint64s(uint64_t hi, uint64_t lo)
 //       Construct from two 64-bit words representing the 128-bit value.
 //
+//   - ulid_t::min_for_timestamp(ms), ulid_t::max_for_timestamp(ms)
+//       The smallest / largest ULID for a millisecond, for range queries over sorted IDs.
+//
+//   - ulid::basic_generator<Engine, Clock, Policy> (ulid::generator for the defaults)
+//       A generator object that owns its PRNG and monotonic state, for use without
+//       thread-local lookups. The static functions above wrap one thread-local instance.
+//       Policy (ulid::rollback) picks what generate_monotonic() does on clock rollback or
+//       random-field exhaustion: reuse (default), wait, borrow_future or fail_fast.
+//       Default-constructed generators are seeded from ulid::seeding: one OS entropy read
+//       per process, then a lock-free splitmix64 stream per generator, reseeded after fork().
+//
+//   - ulid::secure_generator (basic_generator<ChaCha20>)
+//       Unpredictable random fields: a ChaCha20 keystream keyed with 320 bits of OS entropy
+//       per generator (and on every reseed()), buffered 1 KiB at a time.
+//
+//   - ulid::node_generator<K> (basic_generator<Engine, Clock, Policy, K>)
+//       Stores a node / shard number (ulid::node) in the top K (1-16) bits of the random field.
+//       Nodes never collide, and monotonic increments stay in the 80 - K bits below the node.
+//
+//   All four generators take an optional clock policy, e.g. generate<cached_ms_clock>():
+//     system_ms_clock  std::chrono::system_clock (default)
+//     coarse_ms_clock  CLOCK_REALTIME_COARSE / GetSystemTimePreciseAsFileTime
+//     cached_ms_clock  process-wide atomic refreshed every millisecond by a background thread,
+//                      restarted in the child after fork()
+//   The monotonic state is per thread, not per clock, so mixing clocks stays monotonic.
+//
 // Conversion
 // ----------
 //   - ulid_t::to_string() const
 //       Encode as canonical 26-character Crockford Base32.
 //
+//   - ulid_t::to_chars(char* first, char* last) const
+//   - ulid_t::to_chars(span<char,26>) const
+//   - ulid_t::to_chars() const
+//       Allocation-free encoding into a caller buffer, or into a returned array<char,26>.
+//
 //   - ulid_t::to_readable_string() const
-//       Produce the 35-character form with embedded ISO8601 timestamp.
+//   - ulid_t::to_readable_chars(char* first, char* last) const
+//       Produce the 35-character form with embedded ISO8601 timestamp, optionally
+//       straight into a caller buffer.
+//
+//   - ulid_t::to_uuid_chars(char* first, char* last) const / to_uuid_string() const
+//       The 128 bits as lowercase UUID text, eight hex digits per step, without a table.
+//
+//   - ulid_t::to_uuid_v7() const / is_uuid_v7() const
+//       Set or test the RFC 9562 version 7 and variant bits. The timestamp layouts already match.
 //
 //   - ulid_t::to_bytes() const
 //       Return the 16 bytes in big-endian order.
 //
+//   - ulid_t::write_to(span<std::byte>) const -> bool
+//       Store the 16 big-endian bytes at the front of a wire buffer, unaligned, with no
+//       intermediate array; false if the buffer is shorter.
+//
 //   - ulid_t::as_bytes() const
-//       Borrow a span over the 16 bytes.
+//       Same as to_bytes(). The value is held as two native 64-bit words, so the
+//       big-endian bytes are produced on demand rather than borrowed.
 //
 //   - ulid_t::timestamp_ms() const
 //       Extract the 48-bit timestamp as milliseconds since Unix epoch.
 //
+//   - ulid_t::node_id<K>() const
+//       The node number a node_generator<K> stored, by shift and mask.
+//
 //   - ulid_t::to_uint64s() const
-//       Return the 128-bit value as a {hi, lo} pair of 64-bit words.
+//       Return the 128-bit value as a {hi, lo} pair of 64-bit words. This is the
+//       internal representation, so it costs nothing.
 //
 // Ordering
 // --------
 //   - operator<=>, operator==
 //       Strongly ordered across the full 128-bit value.
 //
+// Formatting
+// ----------
+//   - std::formatter<ulid_t>
+//       std::format("{}", id) writes straight to the output, no temporary string.
+//       Spec letters: {} or {:s} canonical, {:r} readable, {:l} lowercase Crockford,
+//       {:u} UUID-style hex (8-4-4-4-12), {:t} timestamp in milliseconds.
+//
+// Hashing
+// -------
+//   - std::hash<ulid_t>, ulid::hasher, ulid::equal_to
+//       Hash only the random field. hasher and equal_to are transparent, so an
+//       unordered_map<ulid_t, V, ulid::hasher, ulid::equal_to> can be searched with
+//       a 26-char string_view directly.
+//
+// Instrumentation
+// ---------------
+//   - ulid::metrics::snapshot() (ulid_metrics.hpp)
+//       With ULID_INSTRUMENTATION=1: per-thread counters for generated IDs, monotonic
+//       increments, clock regressions, parse rejections by reason and suffix headroom.
+//       Without it the hooks compile to nothing and snapshot() returns zeros.
+//
 // Notes
 // -----
 //   - Uses RomuDuoJr by default, but the PRNG backend is pluggable.
@@ -94,158 +207,416 @@
 
 namespace ulid{
 
+	// Clock policies for the generators. Any type with a static, noexcept now_ms()
+	// returning milliseconds since the Unix epoch will do.
+	template<typename C>
+	concept ms_clock = requires{
+		{ C::now_ms() } noexcept -> std::same_as<std::uint64_t>;
+	};
+
+	// The default: std::chrono::system_clock, truncated to milliseconds.
+	struct system_ms_clock final{
+		static std::uint64_t now_ms() noexcept{
+			using namespace std::chrono;
+			return static_cast<std::uint64_t>(
+				duration_cast<milliseconds>(
+					system_clock::now().time_since_epoch()
+				).count()
+				);
+		}
+	};
+
+	// Reads the OS wall clock directly, skipping the chrono conversions.
+	// Linux: CLOCK_REALTIME_COARSE, served from the vDSO without a syscall. Its resolution is the
+	//   kernel tick (1-4 ms), so several milliseconds can share a timestamp.
+	// Windows: GetSystemTimePreciseAsFileTime. (The coarse GetSystemTimeAsFileTime ticks every
+	//   ~15.6 ms, which is too blunt for millisecond timestamps.)
+	// Elsewhere: falls back to system_ms_clock.
+	struct coarse_ms_clock final{
+		static std::uint64_t now_ms() noexcept{
+#if defined(_WIN32)
+			FILETIME ft{};
+			GetSystemTimePreciseAsFileTime(&ft);
+			const std::uint64_t ticks = (std::uint64_t{ft.dwHighDateTime} << 32) | ft.dwLowDateTime; // 100 ns since 1601-01-01
+			constexpr std::uint64_t UNIX_EPOCH_TICKS = 116444736000000000ULL;
+			return (ticks - UNIX_EPOCH_TICKS) / 10000;
+#elif defined(CLOCK_REALTIME_COARSE)
+			timespec ts{};
+			clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+			return static_cast<std::uint64_t>(ts.tv_sec) * 1000 + static_cast<std::uint64_t>(ts.tv_nsec) / 1000000;
+#else
+			return system_ms_clock::now_ms();
+#endif
+		}
+	};
+
+	// A process-wide millisecond cache. One background thread, started on first use, refreshes
+	// an atomic from system_ms_clock about once per millisecond; now_ms() is a single relaxed load.
+	// The value lags the real clock by up to one tick (plus scheduler jitter), which the
+	// monotonic generator treats like any other same-millisecond call.
+	// The ticker does not survive fork(), so on POSIX a pthread_atfork handler marks it stopped in
+	// the child, and the child's first now_ms() starts a new one.
+	class cached_ms_clock final{
+	public:
+		static std::uint64_t now_ms() noexcept{
+			const std::uint64_t ms = ticker().now.load(std::memory_order_relaxed);
+			if(ms == STOPPED) [[unlikely]]{
+				return restart();
+			}
+			return ms;
+		}
+
+	private:
+		static constexpr std::uint64_t STOPPED = 0;
+
+		struct state{
+			std::atomic<std::uint64_t> now{STOPPED};
+			std::atomic<bool> started{false};
+			std::unique_ptr<std::jthread> thread; // joined at exit by ~jthread
+
+			state() noexcept{
+#if !defined(_WIN32)
+				pthread_atfork(nullptr, nullptr, &forget_parent_thread);
+#endif
+			}
+		};
+
+		static state& ticker() noexcept{
+			static state s{};
+			return s;
+		}
+
+		// First use, or first use after fork(): one caller starts the thread, and every racing
+		// caller gets a direct read in the meantime.
+		static std::uint64_t restart() noexcept{
+			state& s = ticker();
+			const std::uint64_t ms = system_ms_clock::now_ms();
+			if(!s.started.exchange(true, std::memory_order_acq_rel)){
+				s.now.store(ms, std::memory_order_relaxed);
+				s.thread = std::make_unique<std::jthread>([&s](std::stop_token stop){
+					while(!stop.stop_requested()){
+						std::this_thread::sleep_for(std::chrono::milliseconds{1});
+						s.now.store(system_ms_clock::now_ms(), std::memory_order_relaxed);
+					}
+				});
+			}
+			return ms;
+		}
+
+		// Runs in the child. The parent's thread does not exist here, so its handle is leaked
+		// rather than joined (which would never return), and the cache reads as stopped.
+		static void forget_parent_thread() noexcept{
+			state& s = ticker();
+			(void)s.thread.release();
+			s.started.store(false, std::memory_order_relaxed);
+			s.now.store(STOPPED, std::memory_order_relaxed);
+		}
+	};
+
+	// Seeding for default-constructed generators. One 64-bit seed is read from the OS on first use;
+	// every generator then takes the next value of a splitmix64 sequence started from it, so threads
+	// get decorrelated streams without a syscall each, however close together they start.
+	namespace seeding{
+		// 64 bits from getrandom (Linux), BCryptGenRandom (Windows) or arc4random_buf (BSD, macOS).
+		// If the OS call fails, falls back to mixing the clocks with a stack address.
+		[[nodiscard]] inline std::uint64_t os_entropy() noexcept{
+			std::uint64_t v = 0;
+#if defined(_WIN32)
+			if(BCRYPT_SUCCESS(BCryptGenRandom(nullptr, reinterpret_cast<PUCHAR>(&v), sizeof(v), BCRYPT_USE_SYSTEM_PREFERRED_RNG))){
+				return v;
+			}
+#elif defined(__linux__)
+			if(getrandom(&v, sizeof(v), 0) == static_cast<ssize_t>(sizeof(v))){
+				return v;
+			}
+#else
+			arc4random_buf(&v, sizeof(v));
+			return v;
+#endif
+			using namespace std::chrono;
+			v = static_cast<std::uint64_t>(high_resolution_clock::now().time_since_epoch().count());
+			v ^= static_cast<std::uint64_t>(system_clock::now().time_since_epoch().count()) * 0x9E3779B97F4A7C15ull;
+			return v ^ static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&v));
+		}
+
+		namespace detail{
+			constexpr std::uint64_t GOLDEN = 0x9E3779B97F4A7C15ull;
+
+			constexpr std::uint64_t splitmix64(std::uint64_t z) noexcept{
+				z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+				z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+				return z ^ (z >> 31);
+			}
+
+			inline void reseed_child() noexcept;
+
+			struct state final{
+				std::atomic<std::uint64_t> next{os_entropy()};
+				std::atomic<std::uint64_t> epoch{0};
+
+				state() noexcept{
+#if !defined(_WIN32)
+					pthread_atfork(nullptr, nullptr, &reseed_child); // the child must not replay the parent's streams
+#endif
+				}
+			};
+
+			inline state& get() noexcept{
+				static state s{};
+				return s;
+			}
+
+			inline void reseed_child() noexcept{
+				get().next.store(os_entropy(), std::memory_order_relaxed);
+				get().epoch.fetch_add(1, std::memory_order_relaxed);
+			}
+		} // namespace detail
+
+		// The next stream seed. Lock-free: one relaxed fetch_add on a process-wide counter.
+		[[nodiscard]] inline std::uint64_t next_seed() noexcept{
+			return detail::splitmix64(detail::get().next.fetch_add(detail::GOLDEN, std::memory_order_relaxed) + detail::GOLDEN);
+		}
+
+		// Bumped by every reseed_after_fork(). The thread-local generators behind ulid_t::generate*()
+		// compare it on use and reseed themselves when it has moved.
+		[[nodiscard]] inline std::uint64_t epoch() noexcept{
+			return detail::get().epoch.load(std::memory_order_relaxed);
+		}
+
+		// Draws a new OS seed and moves the epoch, so every thread-local generator takes a fresh
+		// stream on its next call. Runs automatically in the child after fork() on POSIX
+		// (pthread_atfork); call it yourself after clone() or a raw fork syscall, or to reseed a
+		// worker pool for any other reason. Generators you own are reseeded with their reseed().
+		inline void reseed_after_fork() noexcept{
+			detail::reseed_child();
+		}
+
+		// Engines that need more than a 64-bit seed, like ChaCha20, provide a static
+		// from_entropy(source) that draws its key from source(); generators then key them
+		// straight from os_entropy() instead of next_seed().
+		template<typename E>
+		concept keyed_engine = requires{ { E::from_entropy(&os_entropy) } -> std::same_as<E>; };
+	} // namespace seeding
+
+	// What generate_monotonic() does when the clock reads earlier than the last ID's timestamp,
+	// or when the 80-bit random field is already at its maximum and can't be incremented.
+	enum class rollback : std::uint8_t{
+		reuse,			// keep the last timestamp and increment (the default). The increment wraps after 2^80 IDs in one millisecond.
+		wait,			// yield until the clock is back at the last timestamp, or past it when the random field is used up
+		borrow_future,	// hybrid logical clock: keep the last timestamp while behind; when the random field is used up, move to the next millisecond
+		fail_fast,		// generate_monotonic() returns std::optional: nullopt instead of reusing or wrapping
+	};
+
+	// A node or shard number, stored by node generators in the top NodeBits of the random field.
+	struct node final{
+		std::uint16_t id = 0; // only the low NodeBits bits are used
+	};
+
+	template<typename Engine = RomuDuoJr, ms_clock Clock = system_ms_clock, rollback Policy = rollback::reuse, unsigned NodeBits = 0>
+	class basic_generator;
+
+	struct hasher;
+
 	class ulid_t final{
 	public:
 		using byte = std::uint8_t;
 		using PRNG = rnd::Random<RomuDuoJr>;
-		// Feel free to replace RomuDuoJr with any PRNG you like (e.g. std::mt19937).
+		// Feel free to replace RomuDuoJr with any PRNG you like, as long as it produces 32 or 64 bits per draw.
 		// RomuDuoJr is the default here because it is tiny, extremely fast, and produces
 		// good statistical quality for non-cryptographic identifiers.
 		// see: https://github.com/ulfben/cpp_prngs/ for benchmarks and more information
 
-		[[nodiscard]] static ulid_t generate() noexcept{
-			const auto ts = now_ms();
-			static thread_local auto rng = PRNG{salted_seed(ts)};
-			ulid_t ulid{};
-			write_big_endian<6>(ts, ulid.timestamp_bytes()); //fill timestamp bytes			
-			for(auto& b : ulid.random_bytes()){
-				b = rng.bits_as<byte>(); // get a uniformly-distributed byte from the PRNG.
-					// Similar in use to std::uniform_int_distribution(0,255), but drastically faster.
-			}
-			return ulid;
-		}
+		// The static generators below are thin wrappers over one thread-local basic_generator.
+		// Create your own ulid::generator (or basic_generator<Engine, Clock>) to own the state
+		// and skip the thread-local lookup.
+		template<ms_clock Clock = system_ms_clock>
+		[[nodiscard]] static ulid_t generate() noexcept;
 
-		[[nodiscard]] static ulid_t generate_monotonic() noexcept{
-			const auto ts = now_ms();
-			static thread_local auto rng = PRNG{salted_seed(ts)};
-			static thread_local ulid_t last{}; // previously generated ULID
-			static thread_local std::uint64_t last_ts = 0;
-			static thread_local bool have_last = false;
+		template<ms_clock Clock = system_ms_clock>
+		[[nodiscard]] static ulid_t generate_monotonic() noexcept;
 
-			if(!have_last || ts > last_ts){ // new millisecond: fresh timestamp + fresh randomness			
-				last_ts = ts;
-				write_big_endian<6>(ts, last.timestamp_bytes());
-				for(auto& b : last.random_bytes()){
-					b = rng.bits_as<byte>();
-				}
-				have_last = true;
-			} else{ // same millisecond OR clock went backwards.			
-				// we re-use the same timestamp and just bump the random field.			
-				increment_big_endian(last.random_bytes());
-			}
-			return last;
-		}
+		// Bulk versions of generate() and generate_monotonic(): fill a caller-provided span,
+		// reading the clock and the thread-local PRNG once per batch rather than once per ID.
+		// The random field is taken from whole 64-bit PRNG outputs.
+		template<ms_clock Clock = system_ms_clock>
+		static void generate_n(std::span<ulid_t> out) noexcept;
+
+		// Shares its per-thread state with generate_monotonic(), so the two can be mixed freely
+		// and the combined sequence stays strictly increasing.
+		template<ms_clock Clock = system_ms_clock>
+		static void generate_monotonic_n(std::span<ulid_t> out) noexcept;
 
 		[[nodiscard]] constexpr static ulid_t from_bytes(std::span<const byte, 16> bytes) noexcept{
-			ulid_t ulid{}; // manual copy to avoid pulling in <algorithm>. sorry for the crime scene!
-			ulid.data = {bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7],
+			// manual copy to avoid pulling in <algorithm>. sorry for the crime scene!
+			const std::array<byte, 16> big_endian{bytes[0], bytes[1], bytes[2], bytes[3], bytes[4], bytes[5], bytes[6], bytes[7],
 				bytes[8], bytes[9], bytes[10],bytes[11],bytes[12],bytes[13],bytes[14],bytes[15]
 			};
-			return ulid;
+			const auto words = std::bit_cast<std::array<std::uint64_t, 2>>(big_endian);
+			return from_uint64s(from_big_endian(words[0]), from_big_endian(words[1]));
+		}
+
+		// The 16 big-endian bytes at the front of a wire buffer (alignment doesn't matter), or
+		// std::nullopt if it holds fewer than 16. Inverse of write_to().
+		[[nodiscard]] constexpr static std::optional<ulid_t> read_from(std::span<const std::byte> in) noexcept{
+			if(in.size() < 16){
+				return std::nullopt;
+			}
+			std::array<std::uint64_t, 2> words{};
+			if consteval{
+				std::array<std::byte, 16> big_endian{};
+				for(std::size_t i = 0; i < 16; ++i){ big_endian[i] = in[i]; }
+				words = std::bit_cast<std::array<std::uint64_t, 2>>(big_endian);
+			} else{
+				std::memcpy(words.data(), in.data(), 16); // one unaligned 16-byte load
+			}
+			return from_uint64s(from_big_endian(words[0]), from_big_endian(words[1]));
 		}
 
 		[[nodiscard]] constexpr static ulid_t from_uint64s(std::uint64_t hi, std::uint64_t lo) noexcept{
 			ulid_t ulid{};
-			write_big_endian<8>(hi, ulid.high_bytes());
-			write_big_endian<8>(lo, ulid.low_bytes());
+			ulid.hi = hi;
+			ulid.lo = lo;
 			return ulid;
 		}
 
+		static constexpr std::uint64_t MAX_TIMESTAMP = (std::uint64_t{1} << 48) - 1;
+
+		// The smallest and largest ULIDs with the given timestamp: all-zero and all-one random field.
+		// Handy as lower_bound / upper_bound sentinels. Timestamps past 48 bits clamp to MAX_TIMESTAMP.
+		[[nodiscard]] constexpr static ulid_t min_for_timestamp(std::uint64_t ms) noexcept{
+			return from_uint64s((ms < MAX_TIMESTAMP ? ms : MAX_TIMESTAMP) << 16, 0);
+		}
+
+		[[nodiscard]] constexpr static ulid_t max_for_timestamp(std::uint64_t ms) noexcept{
+			return from_uint64s(((ms < MAX_TIMESTAMP ? ms : MAX_TIMESTAMP) << 16) | 0xFFFFu, ~std::uint64_t{0});
+		}
+
 		[[nodiscard]] constexpr static std::optional<ulid_t> from_string(std::string_view s) noexcept{
-			if(s.size() != 26){ return std::nullopt; }
-			std::array<std::uint64_t, 3> acc{}; // 192-bit accumulator: acc[0] = least significant 64 bits        
-			for(char ch : s){
-				auto v_opt = decode_crockford(ch);
-				if(!v_opt){ return std::nullopt; }
-				std::uint64_t carry = *v_opt; //carry = 0..31      
-				for(auto& a : acc){
-					const std::uint64_t new_carry = a >> (64 - 5);
-					a = (a << 5) | carry;
-					carry = new_carry;
-				}
+			if(s.size() != 26){
+				metrics::detail::count_rejected(metrics::reject::length);
+				return std::nullopt;
 			}
-			// Optional canonicality check: top 2 bits of 130-bit value should be zero.
-			// Those are bits 128 and 129, which correspond to the lowest 2 bits of acc[2].        
-			if((acc[2] & 0x3u) != 0){
+			std::array<std::uint8_t, 26> digits{};
+			std::uint8_t seen = 0; // OR of every decoded digit; valid digits never set the top 3 bits
+			for(std::size_t i = 0; i < 26; ++i){
+				digits[i] = DECODING[static_cast<unsigned char>(s[i])];
+				seen |= digits[i];
+			}
+			// One check for the whole string: any INVALID sentinel shows up in the top bits of seen.
+			// Canonicality: the 26 digits hold 130 bits, so the top 2 bits of the first digit must be zero.
+			if((seen & 0xE0u) != 0 || (digits[0] & 0x18u) != 0){
+				metrics::detail::count_rejected((seen & 0xE0u) != 0 ? metrics::reject::character : metrics::reject::overflow);
 				return std::nullopt;
 			}
-			ulid_t ulid{};
-			write_big_endian<8>(acc[1], ulid.high_bytes()); // high bits are in acc[1] (bits 64..127)
-			write_big_endian<8>(acc[0], ulid.low_bytes()); // low bits are in acc[0] (bits 0..63)
-			return ulid;
+			// Pack straight into the two words. Digits 0..12 (3 + 12*5 = 63 bits) plus the top bit
+			// of digit 13 fill hi; the low 4 bits of digit 13 and digits 14..25 (4 + 12*5 = 64 bits) fill lo.
+			std::uint64_t hi = 0;
+			for(std::size_t i = 0; i < 13; ++i){
+				hi = (hi << 5) | digits[i];
+			}
+			hi = (hi << 1) | (digits[13] >> 4);
+			std::uint64_t lo = digits[13] & 0x0Fu;
+			for(std::size_t i = 14; i < 26; ++i){
+				lo = (lo << 5) | digits[i];
+			}
+			return from_uint64s(hi, lo);
 		}
 
 		// Note: from_readable_string() is an extension and not part of the ULID standard.
 		// Expects "YYYYMMDDThhmmssmmmZrrrrrrrrrrrrrrrr" (35 chars).
 		// Timestamp ends at Z, after which follows 16-char Crockford Base32 randomness (same as canonical ULID)
-		[[nodiscard]] static std::optional<ulid_t> from_readable_string(std::string_view s){			
+		// Dates must be real calendar dates (no Feb 30) and not before 1970-01-01.
+		[[nodiscard]] constexpr static std::optional<ulid_t> from_readable_string(std::string_view s) noexcept{
 			if(s.size() != 35 || s[8] != 'T' || s[18] != 'Z'){
+				metrics::detail::count_rejected(metrics::reject::readable_shape);
 				return std::nullopt;
-			}			
-
-			auto parse_u32 = [](std::string_view s, std::size_t pos, std::size_t len) noexcept -> std::optional<unsigned>{
-				unsigned v{}; 
-				const char* first = s.data() + pos; 
-				const char* last = first + len;
-				auto rc = std::from_chars(first, last, v);
-				if(rc.ec != std::errc{} || rc.ptr != last){
-					return std::nullopt;
+			}
+			bool digits_ok = true;
+			const auto number = [&](std::size_t pos, std::size_t len) noexcept{
+				unsigned v = 0;
+				for(std::size_t i = pos; i < pos + len; ++i){
+					const unsigned d = static_cast<unsigned>(s[i]) - '0';
+					digits_ok &= d < 10;
+					v = v * 10 + d;
 				}
 				return v;
 			};
-
-			auto year_num = parse_u32(s, 0, 4); //0..3   year
-			auto month_num = parse_u32(s, 4, 2); // 4..5   month
-			auto day_num = parse_u32(s, 6, 2); //6..7   day
-			auto hour_num = parse_u32(s, 9, 2); //8 = 'T', 9..10  hour
-			auto minute_num = parse_u32(s, 11, 2); //11..12 minute
-			auto second_num = parse_u32(s, 13, 2); //13..14 second
-			auto millis_num = parse_u32(s, 15, 3); //15..17 millisecond
-
-			if(!year_num || !month_num || !day_num || !hour_num || !minute_num || !second_num || !millis_num){
+			const unsigned year = number(0, 4);
+			const unsigned month = number(4, 2);
+			const unsigned day = number(6, 2);		// 8 = 'T'
+			const unsigned hour = number(9, 2);
+			const unsigned minute = number(11, 2);
+			const unsigned second = number(13, 2);
+			const unsigned millis = number(15, 3);	// 18 = 'Z'
+			if(!digits_ok || year < 1970 || month == 0 || month > 12 || day == 0 || day > days_in_month(year, month)
+				|| hour > 23 || minute > 59 || second > 59){
+				metrics::detail::count_rejected(metrics::reject::readable_field);
 				return std::nullopt;
 			}
-			if(*month_num == 0 || *month_num > 12 || *day_num == 0 || *day_num > 31 || *hour_num > 23 || *minute_num > 59 || *second_num > 59 || *millis_num > 999){
-				return std::nullopt; //failed basic range checks 
+			std::uint64_t top = 0; // the 16-char tail is the 80-bit random field, 5 bits per char
+			std::uint64_t lo = 0;
+			std::uint8_t seen = 0;
+			for(std::size_t i = 19; i < 35; ++i){
+				const std::uint8_t v = DECODING[static_cast<unsigned char>(s[i])];
+				seen |= v;
+				top = (top << 5) | (lo >> 59);
+				lo = (lo << 5) | (v & 0x1Fu);
 			}
-			
-			using namespace std::chrono;
+			if((seen & 0xE0u) != 0){ // an INVALID sentinel somewhere in the tail
+				metrics::detail::count_rejected(metrics::reject::readable_random);
+				return std::nullopt;
+			}
+			const std::uint64_t days = static_cast<std::uint64_t>(days_from_civil(year, month, day));
+			const std::uint64_t timestamp_ms = ((days * 24 + hour) * 60 + minute) * 60'000 + second * 1000 + millis;
+			return from_uint64s((timestamp_ms << 16) | (top & 0xFFFFu), lo);
+		}
 
-			year_month_day ymd{
-				year{static_cast<int>(*year_num)},
-				month{*month_num},
-				day{*day_num}
-			};
-			if(!ymd.ok()){ //calendar validation (feb 30 etc)
+		// The canonical 36-char UUID text (8-4-4-4-12 hex digits, either case) as the same 128 bits.
+		// std::nullopt on a wrong length, a misplaced '-' or a non-hex digit. Branchless: the 32 digits
+		// are validated and decoded eight at a time in 64-bit registers, with no lookup table.
+		[[nodiscard]] constexpr static std::optional<ulid_t> from_uuid_string(std::string_view s) noexcept{
+			if(s.size() != 36 || s[8] != '-' || s[13] != '-' || s[18] != '-' || s[23] != '-'){
+				metrics::detail::count_rejected(metrics::reject::uuid);
+				return std::nullopt;
+			}
+			constexpr std::uint64_t TOP4 = 0xFFFFFFFF00000000ull;
+			const char* p = s.data();
+			std::uint32_t g[4]{};
+			const bool ok = hex_value(load_chars(p), g[0])
+				& hex_value((load_chars(p + 9) & TOP4) | (load_chars(p + 14) >> 32), g[1])
+				& hex_value((load_chars(p + 19) & TOP4) | (load_chars(p + 24) >> 32), g[2])
+				& hex_value(load_chars(p + 28), g[3]);
+			if(!ok){
+				metrics::detail::count_rejected(metrics::reject::uuid);
 				return std::nullopt;
 			}
-						
-			const sys_days day_tp{ymd}; // Start from midnight UTC on that date
-
-			// Add the time-of-day components
-			// The resulting time_point will have millisecond precision.
-			const auto tp =
-				day_tp
-				+ hours{*hour_num}
-				+ minutes{*minute_num}
-				+ seconds{*second_num}
-			+ milliseconds{*millis_num};
-			
-			const auto dur = tp.time_since_epoch();
-			if(dur < milliseconds::zero()){
-				return std::nullopt; // if someone passes a date before 1970-01-01, tp.time_since_epoch() is negative, which would wrap our uint64
-			}
-			
-			const auto timestamp_ms = static_cast<std::uint64_t>(dur.count()); // milliseconds since Unix epoch
-			ulid_t tmp{}; // empty ULID we will populate with the parsed timestamp
-			write_big_endian<6>(timestamp_ms, tmp.timestamp_bytes()); // write the 48-bit timestamp into the first 6 bytes
-			std::string canonical = tmp.to_string(); // encode this partial ULID into canonical 26-char Base32 form
-			canonical.replace(10, 16, s.substr(19, 16)); // splice in the 16-char randomness from the readable input
-			return ulid_t::from_string(canonical); // parse the completed canonical ULID
+			return from_uint64s((std::uint64_t{g[0]} << 32) | g[1], (std::uint64_t{g[2]} << 32) | g[3]);
 		}
 
 		[[nodiscard]] constexpr std::string to_string() const{
-			return encode_base32(data);
+			const auto chars = to_chars();
+			return std::string(chars.data(), chars.size());
+		}
+
+		// Allocation-free encoding into [first, last). Mirrors std::to_chars:
+		// on success returns {first + 26, errc{}}. If the buffer holds fewer than 26 chars
+		// it is left untouched and {last, errc::value_too_large} is returned.
+		constexpr std::to_chars_result to_chars(char* first, char* last) const noexcept{
+			if(last - first < 26){
+				return {last, std::errc::value_too_large};
+			}
+			encode_base32(hi, lo, std::span<char, 26>{first, 26});
+			return {first + 26, std::errc{}};
+		}
+
+		constexpr void to_chars(std::span<char, 26> out) const noexcept{
+			encode_base32(hi, lo, out);
+		}
+
+		[[nodiscard]] constexpr std::array<char, 26> to_chars() const noexcept{
+			std::array<char, 26> out{};
+			encode_base32(hi, lo, out);
+			return out;
 		}
 
 		[[nodiscard]] constexpr explicit operator std::string() const{
@@ -253,19 +624,34 @@ namespace ulid{
 		}
 
 		[[nodiscard]] constexpr std::array<byte, 16> to_bytes() const noexcept{
-			return data;
+			return std::bit_cast<std::array<byte, 16>>(std::array<std::uint64_t, 2>{to_big_endian(hi), to_big_endian(lo)});
+		}
+
+		// Writes the as_bytes() layout straight into out[0..16), with no alignment requirement and
+		// no intermediate array. Returns false, leaving out untouched, if it has fewer than 16 bytes.
+		constexpr bool write_to(std::span<std::byte> out) const noexcept{
+			if(out.size() < 16){
+				return false;
+			}
+			const std::array<std::uint64_t, 2> words{to_big_endian(hi), to_big_endian(lo)};
+			if consteval{
+				const auto big_endian = std::bit_cast<std::array<std::byte, 16>>(words);
+				for(std::size_t i = 0; i < 16; ++i){ out[i] = big_endian[i]; }
+			} else{
+				std::memcpy(out.data(), words.data(), 16); // one unaligned 16-byte store
+			}
+			return true;
 		}
 
-		[[nodiscard]] constexpr std::span<const byte, 16> as_bytes() const noexcept{
-			return std::span<const byte, 16>(data);
+		// The value is stored as two native words, so there are no bytes to borrow: this returns
+		// the big-endian bytes by value, same as to_bytes(). Keep the result alive while you use it.
+		[[nodiscard]] constexpr std::array<byte, 16> as_bytes() const noexcept{
+			return to_bytes();
 		}
 
 		[[nodiscard]] constexpr std::pair<std::uint64_t, std::uint64_t> to_uint64s() const noexcept{
-			const auto bytes = as_bytes();
-			const std::uint64_t hi = read_big_endian_u64(bytes.first<8>());
-			const std::uint64_t lo = read_big_endian_u64(bytes.last<8>());
 			return {hi, lo};
-		}	
+		}
 
 		// Note: to_readable_string() is an extension and not part of the ULID standard.
 		// It rewrites the ULID timestamp: the first 10 Base32 chars are replaced with
@@ -273,31 +659,111 @@ namespace ulid{
 		// The random 16-character suffix is preserved unchanged.
 		// The result is a 35 character string with human readable timestamp. It retains 
 		// millisecond precision and is lexicographically sortable in the same way as a normal ULID.	
-		[[nodiscard]] std::string to_readable_string() const{
-			using namespace std::chrono;
-			using sys_ms = std::chrono::sys_time<std::chrono::milliseconds>;
-			const auto tp = sys_ms{milliseconds{timestamp_ms()}};
-			const auto ms = duration_cast<milliseconds>(tp.time_since_epoch());
-			std::string out = std::format("{:%Y%m%dT%H%M%S}{}Z", //YYYYMMDDThhmmssnnnZ, 19 chars for date-time
-				floor<std::chrono::seconds>(tp),
-				std::format("{:03}", ms.count() % 1000) //handle milliseconds manually
-			);
-			const auto full = to_string();				// 26 chars: 10 ts + 16 random
-			out.append(full.begin() + 10, full.end());  // append last 16 chars			
-			return out; // Final form: "YYYYMMDDThhmmssmmmZrrrrrrrrrrrrrrrr" (35 chars)
+		// (Timestamps past year 9999 get a 5-digit year and 36 chars, which from_readable_string() rejects.)
+		[[nodiscard]] constexpr std::string to_readable_string() const{
+			std::array<char, 36> buf{};
+			const auto result = to_readable_chars(buf.data(), buf.data() + buf.size());
+			return std::string(buf.data(), result.ptr);
 		}
 
-		[[nodiscard]] constexpr std::uint64_t timestamp_ms() const noexcept{
-			std::uint64_t ts = 0;
-			for(const byte b : timestamp_bytes()){
-				ts = (ts << 8) | static_cast<std::uint64_t>(b);
+		// Allocation-free form of to_readable_string(), mirroring to_chars(): writes 35 chars
+		// (36 past year 9999) and returns {end, errc{}}, or {last, errc::value_too_large} if they don't fit.
+		constexpr std::to_chars_result to_readable_chars(char* first, char* last) const noexcept{
+			const std::uint64_t ts = timestamp_ms();
+			const std::uint64_t days = ts / 86'400'000;
+			const std::uint64_t ms_of_day = ts % 86'400'000;
+			const civil_date date = civil_from_days(days);
+			const std::size_t year_width = date.year > 9999 ? 5 : 4;
+			if(static_cast<std::size_t>(last - first) < year_width + 31){
+				return {last, std::errc::value_too_large};
 			}
-			return ts;
+			char* p = write_digits(first, date.year, year_width);
+			p = write_digits(p, date.month, 2);
+			p = write_digits(p, date.day, 2);
+			*p++ = 'T';
+			p = write_digits(p, static_cast<unsigned>(ms_of_day / 3'600'000), 2);
+			p = write_digits(p, static_cast<unsigned>(ms_of_day / 60'000 % 60), 2);
+			p = write_digits(p, static_cast<unsigned>(ms_of_day / 1000 % 60), 2);
+			p = write_digits(p, static_cast<unsigned>(ms_of_day % 1000), 3);
+			*p++ = 'Z';
+			// The random field, same as the last 16 chars of the canonical form: the low 12 chars
+			// are lo's low 60 bits, the first 4 are lo's top 4 bits under the 16 random bits of hi.
+			std::uint64_t bits = lo;
+			for(int i = 15; i >= 4; --i){
+				p[i] = ENCODING[bits & 0x1Fu];
+				bits >>= 5;
+			}
+			bits |= (hi & 0xFFFFu) << 4;
+			for(int i = 3; i >= 0; --i){
+				p[i] = ENCODING[bits & 0x1Fu];
+				bits >>= 5;
+			}
+			return {p + 16, std::errc{}};
+		}
+
+		// The same 128 bits as a lowercase UUID: 8-4-4-4-12 hex digits, 36 chars, no allocation.
+		// Mirrors to_chars(): returns {first + 36, errc{}}, or {last, errc::value_too_large}.
+		constexpr std::to_chars_result to_uuid_chars(char* first, char* last) const noexcept{
+			if(last - first < 36){
+				return {last, std::errc::value_too_large};
+			}
+			const std::uint64_t d1 = hex_digits(static_cast<std::uint32_t>(hi));
+			const std::uint64_t d2 = hex_digits(static_cast<std::uint32_t>(lo >> 32));
+			store_chars(first, hex_digits(static_cast<std::uint32_t>(hi >> 32)), 8);
+			first[8] = '-';
+			store_chars(first + 9, d1, 4);
+			first[13] = '-';
+			store_chars(first + 14, d1 << 32, 4);
+			first[18] = '-';
+			store_chars(first + 19, d2, 4);
+			first[23] = '-';
+			store_chars(first + 24, d2 << 32, 4);
+			store_chars(first + 28, hex_digits(static_cast<std::uint32_t>(lo)), 8);
+			return {first + 36, std::errc{}};
+		}
+
+		[[nodiscard]] constexpr std::array<char, 36> to_uuid_chars() const noexcept{
+			std::array<char, 36> out{};
+			to_uuid_chars(out.data(), out.data() + out.size());
+			return out;
+		}
+
+		[[nodiscard]] std::string to_uuid_string() const{
+			const auto chars = to_uuid_chars();
+			return std::string(chars.data(), chars.size());
+		}
+
+		// RFC 9562 UUIDv7 has the ULID layout, a 48-bit ms timestamp then random bits, except that
+		// 6 of the random bits are fixed: version 0111 in the top 4 bits of the random field and
+		// variant 10 in the top 2 bits of lo. So every UUIDv7 already is a valid ULID, unchanged.
+		// The other way, to_uuid_v7() overwrites those 6 bits and keeps the other 122; it is
+		// lossless for IDs where is_uuid_v7() already holds, so stamp once and store the result.
+		[[nodiscard]] constexpr ulid_t to_uuid_v7() const noexcept{
+			return from_uint64s((hi & ~std::uint64_t{0xF000}) | 0x7000, (lo & ~(std::uint64_t{3} << 62)) | (std::uint64_t{2} << 62));
 		}
 
+		[[nodiscard]] constexpr bool is_uuid_v7() const noexcept{
+			return (hi & 0xF000) == 0x7000 && (lo >> 62) == 2;
+		}
+
+		[[nodiscard]] constexpr std::uint64_t timestamp_ms() const noexcept{
+			return hi >> 16;
+		}
+
+		// The node number a node_generator<K> stored in the top K bits of the random field.
+		// Meaningless for IDs from other generators.
+		template<unsigned K>
+		[[nodiscard]] constexpr std::uint16_t node_id() const noexcept{
+			static_assert(K >= 1 && K <= 16, "node IDs take 1 to 16 bits");
+			return static_cast<std::uint16_t>((hi >> (16 - K)) & ((1u << K) - 1));
+		}
+
+		// Memberwise over {hi, lo}: two word compares, same order as the 16 big-endian bytes.
 		constexpr auto operator<=>(const ulid_t&) const = default;
 
 	private:
+		friend struct hasher; // reads DECODING to hash the string form without building a ulid_t
+
 		static constexpr char ENCODING[32] = {
 			'0','1','2','3','4','5','6','7','8','9',
 			'A','B','C','D','E','F','G','H','J','K',
@@ -305,46 +771,37 @@ namespace ulid{
 			'Y','Z'
 		};
 
-		std::array<byte, 16> data{};
+		// 256-entry reverse lookup for Crockford Base32, indexed by the raw char value.
+		// Accepts lowercase and the ambiguous letters (O/o -> 0, I/i/L/l -> 1); anything else is INVALID.
+		static constexpr std::uint8_t INVALID = 0xFF;
+		static constexpr std::array<std::uint8_t, 256> DECODING = []{
+			std::array<std::uint8_t, 256> table{};
+			for(auto& v : table){ v = INVALID; }
+			for(std::uint8_t i = 0; i < 32; ++i){
+				const char c = ENCODING[i];
+				table[static_cast<unsigned char>(c)] = i;
+				if(c >= 'A' && c <= 'Z'){
+					table[static_cast<unsigned char>(c - 'A' + 'a')] = i;
+				}
+			}
+			table['O'] = table['o'] = 0;
+			table['I'] = table['i'] = table['L'] = table['l'] = 1;
+			return table;
+		}();
 
-		constexpr std::span<byte, 6> timestamp_bytes() noexcept{
-			return std::span<byte, 6>{data.begin(), 6};
-		}
-		constexpr std::span<const byte, 6> timestamp_bytes() const noexcept{
-			return std::span<const byte, 6>{data.cbegin(), 6};
-		}
-		constexpr std::span<byte, 10> random_bytes() noexcept{
-			return std::span<byte, 10>{data.begin() + 6, 10};
-		}
-		constexpr std::span<byte, 8> high_bytes() noexcept{
-			return std::span<byte, 8>{data.begin(), 8};
-		}
-		constexpr std::span<byte, 8> low_bytes() noexcept{
-			return std::span<byte, 8>{data.begin() + 8, 8};
-		}
+		// The 128-bit value as native words; hi must come first for the defaulted operator<=>.
+		std::uint64_t hi = 0; // 48-bit timestamp, then the top 16 random bits
+		std::uint64_t lo = 0; // low 64 random bits
 
-		static std::uint64_t now_ms() noexcept{
-			using namespace std::chrono;
-			return static_cast<std::uint64_t>(
-				duration_cast<milliseconds>(
-					system_clock::now().time_since_epoch()
-				).count()
-				);
-		}
+		using thread_generator_type = basic_generator<PRNG::engine_type, system_ms_clock>;
+		static thread_generator_type& thread_generator() noexcept;
 
-		constexpr static std::string encode_base32(std::span<const byte, 16> bytes){
-			// interpret the 16 bytes as a single 128-bit big-endian integer: N = (hi << 64) | lo
-			// interpret the 16 bytes as a single 128-bit big-endian integer: N = (hi << 64) | lo
-			const std::uint64_t hi = read_big_endian_u64(bytes.first<8>());
-			const std::uint64_t lo = read_big_endian_u64(bytes.last<8>());
-
-			// we want 26 digits, each is 5 bits, covering bits 125..0 of the 128-bit value.
-			std::string out(26, '0');
+		constexpr static void encode_base32(std::uint64_t hi, std::uint64_t lo, std::span<char, 26> out) noexcept{
+			// N = (hi << 64) | lo; we want 26 digits, each is 5 bits, covering bits 125..0 of the 128-bit value.
 			for(int i = 0; i < 26; ++i){
 				const auto digit = extract_digit(hi, lo, i);
 				out[i] = ENCODING[digit];
 			}
-			return out;
 		}
 
 		constexpr static std::uint32_t extract_digit(std::uint64_t hi, std::uint64_t lo, int index) noexcept{
@@ -358,88 +815,503 @@ namespace ulid{
 			return static_cast<std::uint32_t>((hi >> (shift - 64)) & 0x1Fu); // shift in [64, 125], only hits hi		 	
 		}
 
-		constexpr static void increment_big_endian(std::span<byte, 10> rand) noexcept{
-			for(auto it = rand.rbegin(); it != rand.rend(); ++it){ // ULID is big-endian, so increment from least significant byte (back)
-				if(*it != 0xFF){
-					++(*it);
-					return;
-				}
-				*it = 0;
-			}
-			// If we get here, we overflowed 80 bits (all 0xFF -> all 0x00).
-			// Monotonicity within that millisecond is technically broken,
-			// but if you're greedy enough to take 2^80 IDs/ms ... you deserve it. :P
+		// Calendar helpers for the readable form, after Howard Hinnant's days_from_civil / civil_from_days
+		// (http://howardhinnant.github.io/date_algorithms.html). Proleptic Gregorian, UTC, no dates before 1970.
+		struct civil_date{
+			unsigned year;
+			unsigned month;
+			unsigned day;
+		};
+
+		constexpr static civil_date civil_from_days(std::uint64_t days_since_epoch) noexcept{
+			const std::uint64_t z = days_since_epoch + 719468; // days since 0000-03-01
+			const std::uint64_t era = z / 146097;
+			const std::uint64_t doe = z - era * 146097;                                  // [0, 146096]
+			const std::uint64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+			const std::uint64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);             // [0, 365]
+			const std::uint64_t mp = (5 * doy + 2) / 153;                                  // [0, 11], March = 0
+			const auto day = static_cast<unsigned>(doy - (153 * mp + 2) / 5 + 1);
+			const auto month = static_cast<unsigned>(mp < 10 ? mp + 3 : mp - 9);
+			const auto year = static_cast<unsigned>(yoe + era * 400 + (month <= 2 ? 1 : 0));
+			return {year, month, day};
+		}
+
+		// Requires year >= 1970 and a valid month/day.
+		constexpr static std::uint32_t days_from_civil(unsigned year, unsigned month, unsigned day) noexcept{
+			const unsigned y = year - (month <= 2 ? 1 : 0);
+			const unsigned era = y / 400;
+			const unsigned yoe = y - era * 400;
+			const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+			const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+			return era * 146097 + doe - 719468;
+		}
+
+		constexpr static unsigned days_in_month(unsigned year, unsigned month) noexcept{
+			constexpr unsigned DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+			const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+			return month == 2 && leap ? 29 : DAYS[month - 1];
 		}
 
-		//helper for extracting bytes in big-endian order
-		template<std::size_t N>
-		constexpr static void write_big_endian(std::uint64_t value, std::span<byte, N> out) noexcept{
-			static_assert(N <= 8);
-			for(std::size_t i = 0; i < N; ++i){
-				out[i] = static_cast<byte>((value >> ((N - 1 - i) * 8)) & 0xFF);
+		// Writes v as exactly `width` decimal digits, zero padded.
+		constexpr static char* write_digits(char* out, unsigned v, std::size_t width) noexcept{
+			for(std::size_t i = width; i > 0; --i){
+				out[i - 1] = static_cast<char>('0' + v % 10);
+				v /= 10;
 			}
+			return out + width;
+		}
+
+		// 8 lowercase hex digits for x, the first in the top byte: each nibble is spread into its own
+		// byte, then gets '0' added, plus 39 more ('a' - '0' - 10) where it is above 9.
+		constexpr static std::uint64_t hex_digits(std::uint32_t x) noexcept{
+			std::uint64_t v = x;
+			v = ((v & 0x00000000FFFF0000ull) << 16) | (v & 0x000000000000FFFFull);
+			v = ((v & 0x0000FF000000FF00ull) << 8) | (v & 0x000000FF000000FFull);
+			v = ((v & 0x00F000F000F000F0ull) << 4) | (v & 0x000F000F000F000Full);
+			const std::uint64_t above_9 = ((v + 0x0606060606060606ull) >> 4) & 0x0101010101010101ull;
+			return v + 0x3030303030303030ull + above_9 * 0x27;
+		}
+
+		// Inverse of hex_digits() for either case. Bytes below 0x80 can be range-checked in parallel:
+		// adding (0x80 - lo) sets a byte's top bit iff it is >= lo, adding (0x7F - hi) iff it is > hi.
+		constexpr static bool hex_value(std::uint64_t chars, std::uint32_t& out) noexcept{
+			constexpr std::uint64_t ONES = 0x0101010101010101ull;
+			constexpr std::uint64_t HIGH = ONES * 0x80;
+			const std::uint64_t lower = chars | (ONES * 0x20); // 'A'-'F' -> 'a'-'f'; digits already have the bit
+			const std::uint64_t digit = (chars + ONES * (0x80 - '0')) & ~(chars + ONES * (0x7F - '9'));
+			const std::uint64_t letter = (lower + ONES * (0x80 - 'a')) & ~(lower + ONES * (0x7F - 'f'));
+			std::uint64_t v = (chars & (ONES * 0x0F)) + ((letter & HIGH) >> 7) * 9; // 'a' & 0xF is 1
+			v = ((v >> 4) | v) & 0x00FF00FF00FF00FFull;
+			v = ((v >> 8) | v) & 0x0000FFFF0000FFFFull;
+			v = ((v >> 16) | v) & 0x00000000FFFFFFFFull;
+			out = static_cast<std::uint32_t>(v);
+			return (chars & HIGH) == 0 && ((digit | letter) & HIGH) == HIGH;
 		}
 
-		constexpr static std::uint64_t read_big_endian_u64(std::span<const byte, 8> in) noexcept{
+		// 8 chars as one word, the first in the top byte, and back (the first n of them).
+		constexpr static std::uint64_t load_chars(const char* p) noexcept{
 			std::uint64_t v = 0;
-			for(byte b : in){
-				v = (v << 8) | static_cast<std::uint64_t>(b);
+			if consteval{
+				for(int i = 0; i < 8; ++i){ v = (v << 8) | static_cast<unsigned char>(p[i]); }
+			} else{
+				std::memcpy(&v, p, 8);
+				v = from_big_endian(v);
 			}
 			return v;
 		}
 
+		constexpr static void store_chars(char* p, std::uint64_t v, std::size_t n) noexcept{
+			if consteval{
+				for(std::size_t i = 0; i < n; ++i){ p[i] = static_cast<char>(v >> (56 - 8 * i)); }
+			} else{
+				v = to_big_endian(v);
+				std::memcpy(p, &v, n);
+			}
+		}
+
+		// byte order helpers for to_bytes() / from_bytes(); a no-op on big-endian targets
+		constexpr static std::uint64_t to_big_endian(std::uint64_t v) noexcept{
+			if constexpr(std::endian::native == std::endian::little){
+				return std::byteswap(v);
+			} else{
+				return v;
+			}
+		}
+
+		constexpr static std::uint64_t from_big_endian(std::uint64_t v) noexcept{
+			return to_big_endian(v); // a byte swap is its own inverse
+		}
+
 		constexpr static std::optional<std::uint8_t> decode_crockford(char c) noexcept{
-			using u = std::uint8_t;
-			switch(c){
-			case '0': case 'O': case 'o': return u{0};
-			case '1': case 'I': case 'i': case 'L': case 'l': return u{1};
-			case '2': return u{2};
-			case '3': return u{3};
-			case '4': return u{4};
-			case '5': return u{5};
-			case '6': return u{6};
-			case '7': return u{7};
-			case '8': return u{8};
-			case '9': return u{9};
-			case 'A': case 'a': return u{10};
-			case 'B': case 'b': return u{11};
-			case 'C': case 'c': return u{12};
-			case 'D': case 'd': return u{13};
-			case 'E': case 'e': return u{14};
-			case 'F': case 'f': return u{15};
-			case 'G': case 'g': return u{16};
-			case 'H': case 'h': return u{17};
-			case 'J': case 'j': return u{18};
-			case 'K': case 'k': return u{19};
-			case 'M': case 'm': return u{20};
-			case 'N': case 'n': return u{21};
-			case 'P': case 'p': return u{22};
-			case 'Q': case 'q': return u{23};
-			case 'R': case 'r': return u{24};
-			case 'S': case 's': return u{25};
-			case 'T': case 't': return u{26};
-			case 'V': case 'v': return u{27};
-			case 'W': case 'w': return u{28};
-			case 'X': case 'x': return u{29};
-			case 'Y': case 'y': return u{30};
-			case 'Z': case 'z': return u{31};
-			default:
+			const std::uint8_t v = DECODING[static_cast<unsigned char>(c)];
+			if(v == INVALID){
 				return std::nullopt;
 			}
+			return v;
+		}
+
+	};
+
+	// Owns everything needed to generate ULIDs: the PRNG, and the last timestamp and value for
+	// monotonic generation. Not thread-safe; keep one per thread, per core slot, or inside
+	// whatever hot struct needs IDs. Monotonicity holds per generator instance.
+	// Every call has an overload taking an explicit timestamp (ms since Unix epoch) instead of reading Clock.
+	// Policy picks the behavior on clock rollback and random-field exhaustion, see ulid::rollback.
+	// rollback::wait can only wait when it reads the clock itself; the explicit-timestamp overloads
+	// keep the last timestamp while behind and move on to the next millisecond when exhausted.
+	//
+	// NodeBits > 0 makes a node generator (see ulid::node_generator): the top NodeBits of every
+	// ID's random field hold the node number given at construction, the remaining 80 - NodeBits
+	// are random and are what generate_monotonic() increments. The increment never carries into
+	// the node bits: once the lower field is full, it wraps (reuse) or the rollback policy applies.
+	template<typename Engine, ms_clock Clock, rollback Policy, unsigned NodeBits>
+	class basic_generator final{
+		static_assert(NodeBits <= 16, "node IDs take at most the 16 random bits of the high word");
+
+	public:
+		using engine_type = Engine;
+		using clock_type = Clock;
+		using prng_type = rnd::Random<Engine>;
+		using result_type = typename prng_type::result_type;
+		static constexpr rollback rollback_policy = Policy;
+		static constexpr unsigned node_bits = NodeBits;
+
+		// std::optional<ulid_t> / number of IDs written under rollback::fail_fast.
+		using monotonic_result = std::conditional_t<Policy == rollback::fail_fast, std::optional<ulid_t>, ulid_t>;
+		using monotonic_n_result = std::conditional_t<Policy == rollback::fail_fast, std::size_t, void>;
+
+		// Takes its own stream from seeding::next_seed(), so generators created at the same moment
+		// (e.g. one per thread of a pool) never share or correlate their random streams.
+		// A seeding::keyed_engine is keyed from OS entropy instead.
+		basic_generator() noexcept requires(NodeBits == 0) : rng{fresh_prng()}{}
+		explicit constexpr basic_generator(result_type seed) noexcept requires(NodeBits == 0) : rng{seed}{}
+		explicit constexpr basic_generator(prng_type prng) noexcept requires(NodeBits == 0) : rng{prng}{}
+
+		// Node generators must be told their node.
+		explicit basic_generator(node n) noexcept requires(NodeBits > 0)
+			: rng{fresh_prng()}, node_field{node_field_of(n)}{}
+		constexpr basic_generator(node n, result_type seed) noexcept requires(NodeBits > 0)
+			: rng{seed}, node_field{node_field_of(n)}{}
+		constexpr basic_generator(node n, prng_type prng) noexcept requires(NodeBits > 0)
+			: rng{prng}, node_field{node_field_of(n)}{}
+
+		[[nodiscard]] ulid_t generate() noexcept{
+			return generate(Clock::now_ms());
+		}
+		[[nodiscard]] constexpr ulid_t generate(std::uint64_t ts) noexcept{
+			metrics::detail::count_generated();
+			const auto [top, low] = random_80();
+			return ulid_t::from_uint64s((ts << 16) | top, low); // the shift drops everything above 48 bits
+		}
+
+		[[nodiscard]] monotonic_result generate_monotonic() noexcept{
+			return generate_monotonic(read_clock());
+		}
+		// Under rollback::fail_fast: std::nullopt, with the state unchanged, if ts is earlier than the
+		// last ID's timestamp, or equal to it with the random field used up.
+		[[nodiscard]] constexpr monotonic_result generate_monotonic(std::uint64_t ts) noexcept{
+			if constexpr(Policy == rollback::fail_fast){
+				if(have_last && (ts < last_ts || (ts == last_ts && random_exhausted()))){
+					if(ts < last_ts){
+						metrics::detail::count_clock_regression(last_ts - ts);
+					}
+					return std::nullopt;
+				}
+			}
+			metrics::detail::count_generated();
+			advance(ts);
+			return ulid_t::from_uint64s(last_hi, last_lo);
+		}
+
+		void generate_n(std::span<ulid_t> out) noexcept{
+			generate_n(out, Clock::now_ms());
+		}
+		constexpr void generate_n(std::span<ulid_t> out, std::uint64_t ts) noexcept{
+			for(auto& ulid : out){
+				ulid = generate(ts);
+			}
+		}
+
+		monotonic_n_result generate_monotonic_n(std::span<ulid_t> out) noexcept{
+			return generate_monotonic_n(out, read_clock());
+		}
+		// Under rollback::fail_fast, stops at the first failure and returns how many IDs were written.
+		constexpr monotonic_n_result generate_monotonic_n(std::span<ulid_t> out, std::uint64_t ts) noexcept{
+			if constexpr(Policy == rollback::fail_fast){
+				for(std::size_t i = 0; i < out.size(); ++i){
+					const auto id = generate_monotonic(ts);
+					if(!id){
+						return i;
+					}
+					out[i] = *id;
+				}
+				return out.size();
+			} else{
+				for(auto& ulid : out){
+					ulid = generate_monotonic(ts);
+				}
+			}
 		}
 
-		//helper for mixing in per-thread entropy, ensuring each thread has its own random stream
-		static std::uint64_t salted_seed(std::uint64_t timestamp) noexcept{
-			static thread_local std::uint64_t dummy{};
-			auto salt = reinterpret_cast<std::uintptr_t>(&dummy);
-			return timestamp ^ static_cast<std::uint64_t>(salt);
+		// Switches to a fresh stream, as the default constructor picks it. The next monotonic ID then starts a
+		// new millisecond, at least one past the last ID, so after fork() a child that reseeds
+		// neither repeats the parent's IDs nor breaks its own ordering.
+		void reseed() noexcept{
+			rng = fresh_prng();
+			fresh_after_reseed = have_last;
 		}
 
+		constexpr prng_type& prng() noexcept{ return rng; }
+		constexpr const prng_type& prng() const noexcept{ return rng; }
+
+	private:
+		prng_type rng;
+		std::uint64_t last_hi = 0; // previously generated ULID, as ulid_t::to_uint64s() words
+		std::uint64_t last_lo = 0;
+		std::uint64_t last_ts = 0;
+		bool have_last = false;
+		bool fresh_after_reseed = false;
+		std::uint64_t node_field = 0; // the node number, already in place in the low 16 bits of hi
+
+		// The random bits of hi's low 16 that are not node bits.
+		static constexpr std::uint64_t FREE_HI = 0xFFFFu >> NodeBits;
+
+		static constexpr std::uint64_t node_field_of(node n) noexcept{
+			return (static_cast<std::uint64_t>(n.id) << (16 - NodeBits)) & 0xFFFFu;
+		}
+
+		static prng_type fresh_prng() noexcept{
+			if constexpr(seeding::keyed_engine<Engine>){
+				return prng_type{Engine::from_entropy(&seeding::os_entropy)};
+			} else{
+				return prng_type{static_cast<result_type>(seeding::next_seed())};
+			}
+		}
+
+		// 80 random bits from whole engine outputs: {top 16 bits, low 64 bits}.
+		// A 64-bit engine needs two draws (16 + 64 bits), a 32-bit engine three (16 + 32 + 32).
+		constexpr std::pair<std::uint64_t, std::uint64_t> random_80() noexcept{
+			static_assert(prng_type::BITS == 32 || prng_type::BITS == 64, "Engine must produce 32 or 64 bits per draw");
+			const std::uint64_t top = rng.template bits<16>();
+			std::uint64_t low = rng.next();
+			if constexpr(prng_type::BITS == 32){
+				low = (low << 32) | rng.next();
+			}
+			if constexpr(NodeBits > 0){
+				return {(top & FREE_HI) | node_field, low};
+			}
+			return {top, low};
+		}
+
+		constexpr void advance(std::uint64_t ts) noexcept{
+			if(!have_last || ts > last_ts){ // new millisecond: fresh timestamp + fresh randomness
+				start_millisecond(ts);
+			} else if(fresh_after_reseed){
+				start_millisecond(last_ts + 1);
+			} else{ // same millisecond OR clock went backwards.
+				// we re-use the same timestamp and just bump the 80-bit random field.
+				if(ts < last_ts){
+					metrics::detail::count_clock_regression(last_ts - ts);
+				}
+				if constexpr(Policy == rollback::wait || Policy == rollback::borrow_future){
+					if(random_exhausted()){ // borrow the next millisecond rather than wrap
+						start_millisecond(last_ts + 1);
+						return;
+					}
+				}
+				increment_random();
+				metrics::detail::count_increment(last_hi & FREE_HI, last_lo, 16 - NodeBits); // headroom of the incrementable bits
+			}
+		}
+
+		constexpr void start_millisecond(std::uint64_t ts) noexcept{
+			fresh_after_reseed = false;
+			last_ts = ts;
+			const auto [top, low] = random_80();
+			last_hi = (ts << 16) | top;
+			last_lo = low;
+			have_last = true;
+		}
+
+		[[nodiscard]] constexpr bool random_exhausted() const noexcept{
+			return (last_hi & FREE_HI) == FREE_HI && last_lo == ~std::uint64_t{0};
+		}
+
+		// Clock::now_ms(), except that rollback::wait yields until the clock has caught up.
+		std::uint64_t read_clock() noexcept{
+			std::uint64_t ts = Clock::now_ms();
+			if constexpr(Policy == rollback::wait){
+				if(have_last && ts < last_ts){
+					metrics::detail::count_clock_regression(last_ts - ts);
+				}
+				while(have_last && (ts < last_ts || (ts == last_ts && random_exhausted()))){
+					std::this_thread::yield();
+					ts = Clock::now_ms();
+				}
+			}
+			return ts;
+		}
+
+		// Adds one to the 80-bit random field (the low 16 bits of hi and all of lo), big-endian style.
+		// Node bits are left alone: only the 80 - NodeBits below them count.
+		constexpr void increment_random() noexcept{
+			if(++last_lo != 0){
+				return;
+			}
+			last_hi = (last_hi & ~FREE_HI) | ((last_hi + 1) & FREE_HI);
+			// If the top 16 bits wrapped too, we overflowed 80 bits (all 0xFF -> all 0x00).
+			// Monotonicity within that millisecond is technically broken,
+			// but if you're greedy enough to take 2^80 IDs/ms ... you deserve it. :P
+		}
 	};
 
+	using generator = basic_generator<>;
+	using secure_generator = basic_generator<ChaCha20>;
 
+	// IDs tagged with one of 2^NodeBits node numbers, e.g. node_generator<8> gen{ulid::node{42}}.
+	// Generators on different nodes can never collide, and id.node_id<NodeBits>() recovers the node.
+	template<unsigned NodeBits, typename Engine = RomuDuoJr, ms_clock Clock = system_ms_clock, rollback Policy = rollback::reuse>
+	using node_generator = basic_generator<Engine, Clock, Policy, NodeBits>;
+
+	template<ms_clock Clock>
+	ulid_t ulid_t::generate() noexcept{
+		return thread_generator().generate(Clock::now_ms());
+	}
+
+	template<ms_clock Clock>
+	ulid_t ulid_t::generate_monotonic() noexcept{
+		return thread_generator().generate_monotonic(Clock::now_ms());
+	}
+
+	template<ms_clock Clock>
+	void ulid_t::generate_n(std::span<ulid_t> out) noexcept{
+		thread_generator().generate_n(out, Clock::now_ms());
+	}
+
+	template<ms_clock Clock>
+	void ulid_t::generate_monotonic_n(std::span<ulid_t> out) noexcept{
+		thread_generator().generate_monotonic_n(out, Clock::now_ms());
+	}
+
+	inline ulid_t::thread_generator_type& ulid_t::thread_generator() noexcept{
+		static thread_local thread_generator_type instance{};
+		static thread_local std::uint64_t epoch = seeding::epoch();
+		if(const std::uint64_t now = seeding::epoch(); now != epoch) [[unlikely]]{
+			epoch = now;
+			instance.reseed();
+		}
+		return instance;
+	}
 
 	inline std::ostream& operator<<(std::ostream& os, const ulid_t& id){
-		return os << id.to_string();
+		const auto chars = id.to_chars(); // no temporary std::string
+		return os << std::string_view(chars.data(), chars.size());
+	}
+
+	inline namespace literals{
+		// "01ARZ3NDEKTSV4RRFFQ69G5FAV"_ulid. consteval, so the value is baked into the binary and a
+		// malformed literal is a compile error rather than a runtime nullopt. Lowercase and the
+		// ambiguous letters are accepted, as in from_string().
+		consteval ulid_t operator""_ulid(const char* s, std::size_t n){
+			const auto parsed = ulid_t::from_string({s, n});
+			if(!parsed){
+				throw "invalid ULID literal: expected 26 Crockford Base32 chars, first char 0-7";
+			}
+			return *parsed;
+		}
+	} // namespace literals
+
+	// Hashes only the 80-bit random field, which is already uniform: the low 64 bits plus the
+	// top 16 random bits folded in with one multiply. The timestamp is left out on purpose, so
+	// IDs built by hand with a constant random field (e.g. from_uint64s(ts << 16, 0)) all collide.
+	// Transparent: also hashes the 26-char string form, decoding just the last 16 chars (the random
+	// field), so heterogeneous lookups need no temporary ulid_t. Pair it with ulid::equal_to.
+	struct hasher final{
+		using is_transparent = void;
+
+		[[nodiscard]] constexpr std::size_t operator()(const ulid_t& id) const noexcept{
+			const auto [hi, lo] = id.to_uint64s();
+			return fold(hi & 0xFFFFu, lo);
+		}
+
+		// Strings that are not valid ULIDs still hash to something; equal_to then rejects them.
+		[[nodiscard]] constexpr std::size_t operator()(std::string_view s) const noexcept{
+			if(s.size() != 26){
+				return 0;
+			}
+			std::uint64_t top = 0; // chars 10..25 hold exactly the 80 random bits, 5 per char
+			std::uint64_t lo = 0;
+			for(std::size_t i = 10; i < 26; ++i){
+				const std::uint64_t v = ulid_t::DECODING[static_cast<unsigned char>(s[i])] & 0x1Fu;
+				top = (top << 5) | (lo >> 59);
+				lo = (lo << 5) | v;
+			}
+			return fold(top & 0xFFFFu, lo);
+		}
+
+	private:
+		constexpr static std::size_t fold(std::uint64_t top16, std::uint64_t lo) noexcept{
+			const std::uint64_t h = lo ^ (top16 * 0x9E3779B97F4A7C15ull);
+			if constexpr(sizeof(std::size_t) < sizeof(std::uint64_t)){
+				return static_cast<std::size_t>(h ^ (h >> 32));
+			} else{
+				return static_cast<std::size_t>(h);
+			}
+		}
+	};
+
+	// Transparent equality to go with ulid::hasher. A string compares equal only if it parses.
+	struct equal_to final{
+		using is_transparent = void;
+
+		[[nodiscard]] constexpr bool operator()(const ulid_t& a, const ulid_t& b) const noexcept{
+			return a == b;
+		}
+		[[nodiscard]] constexpr bool operator()(const ulid_t& a, std::string_view b) const noexcept{
+			const auto parsed = ulid_t::from_string(b);
+			return parsed && *parsed == a;
+		}
+		[[nodiscard]] constexpr bool operator()(std::string_view a, const ulid_t& b) const noexcept{
+			return (*this)(b, a);
+		}
+	};
+} //namespace ulid
+
+template<>
+struct std::hash<ulid::ulid_t>{
+	[[nodiscard]] constexpr std::size_t operator()(const ulid::ulid_t& id) const noexcept{
+		return ulid::hasher{}(id);
 	}
-} //namespace ulid
\ No newline at end of file
+};
+
+// Writes through a stack buffer into ctx.out(), so formatting never allocates.
+template<>
+struct std::formatter<ulid::ulid_t>{
+	constexpr auto parse(std::format_parse_context& ctx){
+		auto it = ctx.begin();
+		if(it != ctx.end() && *it != '}'){
+			switch(*it){
+			case 's': case 'r': case 'l': case 'u': case 't':
+				presentation = *it++;
+				break;
+			default:
+				throw std::format_error("invalid format spec for ulid_t, expected one of s, r, l, u, t");
+			}
+		}
+		if(it != ctx.end() && *it != '}'){
+			throw std::format_error("invalid format spec for ulid_t, expected a single letter");
+		}
+		return it;
+	}
+
+	template<typename FormatContext>
+	auto format(const ulid::ulid_t& id, FormatContext& ctx) const{
+		std::array<char, 36> buf{};
+		char* end = buf.data();
+		switch(presentation){
+		case 'r':
+			end = id.to_readable_chars(buf.data(), buf.data() + buf.size()).ptr;
+			break;
+		case 'l':
+			end = id.to_chars(buf.data(), buf.data() + buf.size()).ptr;
+			for(char* p = buf.data(); p != end; ++p){
+				*p = static_cast<char>(*p | 0x20); // Crockford is digits and uppercase letters; digits already have bit 5 set
+			}
+			break;
+		case 'u':
+			end = id.to_uuid_chars(buf.data(), buf.data() + buf.size()).ptr;
+			break;
+		case 't':
+			end = std::to_chars(buf.data(), buf.data() + buf.size(), id.timestamp_ms()).ptr;
+			break;
+		default:
+			end = id.to_chars(buf.data(), buf.data() + buf.size()).ptr;
+			break;
+		}
+		return text.format(std::string_view(buf.data(), static_cast<std::size_t>(end - buf.data())), ctx);
+	}
+
+private:
+	char presentation = 's';
+	std::formatter<std::string_view> text{}; // default spec; writes the buffer in one block rather than char by char
+};
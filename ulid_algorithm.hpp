@@ -0,0 +1,237 @@
+#pragma once
+#include "ulid.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+// ulid_algorithm.hpp - algorithms over spans of ULIDs.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::sort(span<ulid_t>)
+//   - ulid::sort(span<ulid_t>, unsigned threads)
+//       In-place MSD radix sort (American flag sort) on the 128-bit value, one byte per level.
+//       Same result as std::sort with operator<. One pass up front ANDs and ORs every key to
+//       find the bytes that are identical across the whole span; those levels are skipped.
+//       Within one batch that is usually most of the timestamp, so random input of n IDs
+//       needs only about log256(n) + 2 partition passes. No scratch memory is allocated.
+//
+//   - ulid::time_range(span<const ulid_t> sorted, t0, t1)
+//       The subspan whose timestamps lie in [t0, t1], by interpolation search on the 48-bit
+//       timestamp: O(log log n) probes for evenly spread timestamps, and never more than about
+//       twice binary search's, since a step that fails to halve the range is followed by a bisection.
+//
+//   - ulid::for_each_time_bucket(span<const ulid_t> sorted, bucket_ms, f)
+//       Calls f(bucket_start_ms, subspan) for every non-empty bucket_ms-wide time bucket,
+//       e.g. 60'000 for minutes. Boundaries are found by search, not by visiting each ID.
+
+namespace ulid{
+
+	namespace detail{
+		// Byte k of the 128-bit value, k = 0 being the most significant.
+		constexpr unsigned key_byte(const ulid_t& id, unsigned k) noexcept{
+			const auto [hi, lo] = id.to_uint64s();
+			const std::uint64_t word = k < 8 ? hi : lo;
+			return static_cast<unsigned>((word >> (56 - 8 * (k % 8))) & 0xFF);
+		}
+
+		// Bit k set where byte k differs somewhere in the span.
+		inline std::uint32_t varying_bytes(std::span<const ulid_t> ids) noexcept{
+			std::uint64_t hi_and = ~std::uint64_t{0}, lo_and = ~std::uint64_t{0};
+			std::uint64_t hi_or = 0, lo_or = 0;
+			for(const auto& id : ids){
+				const auto [hi, lo] = id.to_uint64s();
+				hi_and &= hi; hi_or |= hi;
+				lo_and &= lo; lo_or |= lo;
+			}
+			const std::uint64_t hi_diff = hi_and ^ hi_or;
+			const std::uint64_t lo_diff = lo_and ^ lo_or;
+			std::uint32_t mask = 0;
+			for(unsigned k = 0; k < 8; ++k){
+				mask |= static_cast<std::uint32_t>(((hi_diff >> (56 - 8 * k)) & 0xFF) != 0) << k;
+				mask |= static_cast<std::uint32_t>(((lo_diff >> (56 - 8 * k)) & 0xFF) != 0) << (k + 8);
+			}
+			return mask;
+		}
+
+		// Next byte at or after k that varies, or 16 when none is left.
+		constexpr unsigned next_varying(std::uint32_t varying, unsigned k) noexcept{
+			while(k < 16 && (varying & (1u << k)) == 0){ ++k; }
+			return k;
+		}
+
+		inline constexpr std::size_t RADIX_CUTOFF = 64; // below this, std::sort wins
+
+		// Partitions ids in place on byte k. bounds[b]..bounds[b + 1] is bucket b afterwards.
+		inline void partition_on_byte(std::span<ulid_t> ids, unsigned k, std::array<std::size_t, 257>& bounds) noexcept{
+			std::array<std::size_t, 256> count{};
+			for(const auto& id : ids){
+				++count[key_byte(id, k)];
+			}
+			std::array<std::size_t, 256> head{};
+			bounds[0] = 0;
+			for(unsigned b = 0; b < 256; ++b){
+				head[b] = bounds[b];
+				bounds[b + 1] = bounds[b] + count[b];
+			}
+			if(count[key_byte(ids[0], k)] == ids.size()){
+				return; // every key has the same byte here; nothing moves
+			}
+			for(unsigned b = 0; b < 256; ++b){
+				while(head[b] < bounds[b + 1]){
+					ulid_t v = ids[head[b]];
+					unsigned d = key_byte(v, k);
+					while(d != b){ // follow the cycle until something belongs in this slot
+						std::swap(v, ids[head[d]++]);
+						d = key_byte(v, k);
+					}
+					ids[head[b]++] = v;
+				}
+			}
+		}
+
+		// Index of the first id with timestamp_ms() >= ts. `sorted` must be sorted.
+		inline std::size_t timestamp_lower_bound(std::span<const ulid_t> sorted, std::uint64_t ts) noexcept{
+			std::size_t lo = 0;
+			std::size_t hi = sorted.size(); // the answer is always in [lo, hi]
+			bool bisect = false;
+			while(hi - lo > 8){
+				const std::uint64_t first = sorted[lo].timestamp_ms();
+				const std::uint64_t last = sorted[hi - 1].timestamp_ms();
+				if(ts <= first){ return lo; }
+				if(ts > last){ return hi; }
+				std::size_t probe = lo + (hi - lo) / 2;
+				if(!bisect){ // first < ts <= last here, so last - first > 0
+					const double fraction = static_cast<double>(ts - first) / static_cast<double>(last - first);
+					probe = lo + static_cast<std::size_t>(fraction * static_cast<double>(hi - 1 - lo));
+					probe = std::clamp(probe, lo + 1, hi - 1); // ts > sorted[lo], so lo itself is never the answer
+				}
+				const std::size_t before = hi - lo;
+				if(sorted[probe].timestamp_ms() < ts){
+					lo = probe + 1;
+				} else{
+					hi = probe;
+				}
+				bisect = (hi - lo) > before / 2;
+			}
+			while(lo < hi && sorted[lo].timestamp_ms() < ts){ ++lo; }
+			return lo;
+		}
+
+		inline void radix_sort_from(std::span<ulid_t> ids, unsigned k, std::uint32_t varying) noexcept{
+			if(ids.size() <= RADIX_CUTOFF){
+				std::sort(ids.begin(), ids.end());
+				return;
+			}
+			k = next_varying(varying, k);
+			if(k == 16){
+				return; // all remaining bytes are equal
+			}
+			std::array<std::size_t, 257> bounds{};
+			partition_on_byte(ids, k, bounds);
+			for(unsigned b = 0; b < 256; ++b){
+				const std::size_t size = bounds[b + 1] - bounds[b];
+				if(size > 1){
+					radix_sort_from(ids.subspan(bounds[b], size), k + 1, varying);
+				}
+			}
+		}
+	} // namespace detail
+
+	inline void sort(std::span<ulid_t> ids) noexcept{
+		if(ids.size() <= detail::RADIX_CUTOFF){
+			std::sort(ids.begin(), ids.end());
+			return;
+		}
+		detail::radix_sort_from(ids, 0, detail::varying_bytes(ids));
+	}
+
+	// Parallel version. The top levels are partitioned on the calling thread until every
+	// bucket is small enough to balance; the buckets are then sorted by `threads` workers
+	// (the caller among them). threads == 0 uses std::thread::hardware_concurrency().
+	// Allocates a small task list and may throw std::system_error if a thread cannot start.
+	inline void sort(std::span<ulid_t> ids, unsigned threads){
+		if(threads == 0){
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		if(threads == 1 || ids.size() < 1u << 16){
+			sort(ids);
+			return;
+		}
+		const std::uint32_t varying = detail::varying_bytes(ids);
+		struct task{
+			std::span<ulid_t> ids;
+			unsigned k;
+		};
+		const std::size_t target = ids.size() / (threads * 4); // split until tasks are this small
+		std::vector<task> tasks;
+		std::vector<task> pending{{ids, 0}};
+		while(!pending.empty()){
+			const task t = pending.back();
+			pending.pop_back();
+			const unsigned k = detail::next_varying(varying, t.k);
+			if(t.ids.size() <= target || t.ids.size() <= detail::RADIX_CUTOFF || k == 16){
+				tasks.push_back(t);
+				continue;
+			}
+			std::array<std::size_t, 257> bounds{};
+			detail::partition_on_byte(t.ids, k, bounds);
+			for(unsigned b = 0; b < 256; ++b){
+				const std::size_t size = bounds[b + 1] - bounds[b];
+				if(size > 1){
+					pending.push_back({t.ids.subspan(bounds[b], size), k + 1});
+				}
+			}
+		}
+		std::sort(tasks.begin(), tasks.end(), [](const task& a, const task& b){ return a.ids.size() > b.ids.size(); });
+
+		std::atomic<std::size_t> next{0};
+		auto worker = [&]{
+			for(std::size_t i = next.fetch_add(1, std::memory_order_relaxed); i < tasks.size(); i = next.fetch_add(1, std::memory_order_relaxed)){
+				detail::radix_sort_from(tasks[i].ids, tasks[i].k, varying);
+			}
+		};
+		{
+			std::vector<std::jthread> pool;
+			pool.reserve(threads - 1);
+			for(unsigned t = 1; t < threads; ++t){
+				pool.emplace_back(worker);
+			}
+			worker();
+		}
+	}
+
+	// IDs in `sorted` whose timestamp lies in [t0, t1], both ends inclusive. Empty if t0 > t1.
+	[[nodiscard]] inline std::span<const ulid_t> time_range(std::span<const ulid_t> sorted, std::uint64_t t0, std::uint64_t t1) noexcept{
+		if(t0 > t1){
+			return {};
+		}
+		const std::size_t first = detail::timestamp_lower_bound(sorted, t0);
+		const auto rest = sorted.subspan(first);
+		const std::size_t count = t1 >= ulid_t::MAX_TIMESTAMP ? rest.size() : detail::timestamp_lower_bound(rest, t1 + 1);
+		return rest.first(count);
+	}
+
+	// Calls f(bucket_start_ms, span<const ulid_t>) once per non-empty bucket of bucket_ms
+	// milliseconds, in order. Buckets are aligned to the Unix epoch: start = ts - ts % bucket_ms.
+	template<typename F>
+	void for_each_time_bucket(std::span<const ulid_t> sorted, std::uint64_t bucket_ms, F&& f){
+		if(bucket_ms == 0){
+			bucket_ms = 1;
+		}
+		while(!sorted.empty()){
+			const std::uint64_t ts = sorted.front().timestamp_ms();
+			const std::uint64_t start = ts - ts % bucket_ms;
+			const std::uint64_t next = start + bucket_ms; // may pass MAX_TIMESTAMP; then the rest is one bucket
+			const std::size_t count = next > ulid_t::MAX_TIMESTAMP ? sorted.size() : detail::timestamp_lower_bound(sorted, next);
+			f(start, sorted.first(count));
+			sorted = sorted.subspan(count);
+		}
+	}
+} // namespace ulid
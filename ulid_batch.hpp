@@ -0,0 +1,524 @@
+#pragma once
+#include "ulid.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ULID_SIMD_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && (!defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ULID_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit wider instructions inside functions that ask for them,
+// which lets us dispatch at runtime without compiling the whole TU with -mavx2.
+#if defined(__GNUC__) || defined(__clang__)
+#define ULID_TARGET(features) __attribute__((target(features)))
+#else
+#define ULID_TARGET(features)
+#endif
+
+// ulid_batch.hpp - batch Base32 encoding and decoding for spans of ULIDs.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::encode_many(span<const ulid_t>, span<char>)
+//       Encode ids back-to-back into a packed buffer of 26 chars per id.
+//       Uses SSE4.1, AVX2 or NEON when the CPU supports it (detected once, at runtime),
+//       and falls back to ulid_t::to_chars(). All paths produce identical output.
+//
+//   - ulid::decode_many(span<const char>, span<ulid_t>, span<uint64_t> invalid = {})
+//       Validate and decode packed 26-char records in bulk. Bad records don't stop the batch:
+//       they are counted, zeroed, and flagged in an optional per-element bitmap.
+//
+//   - ulid::detected_simd_level(), ulid::is_supported(simd_level)
+//       The best instruction set available on this machine, and whether a given one can run.
+//
+// How the vector path works:
+//   The 128-bit value is padded with 2 zero bits on the left to get 130 bits = 26 digits.
+//   Digit i therefore starts at bit b = 5*i - 2 (counted from the most significant bit),
+//   and always fits in the 16-bit window formed by big-endian bytes b/8 and b/8 + 1.
+//   A byte shuffle gathers that window into a 16-bit lane, a per-lane multiply shifts
+//   the digit up to bits 15..11, and one fixed shift right by 11 isolates it.
+//   Finally the 32-entry alphabet is looked up with two 16-entry shuffles (or one tbl on NEON).
+
+namespace ulid{
+
+	enum class simd_level : std::uint8_t{
+		scalar,
+		sse41,
+		avx2,
+		neon
+	};
+
+	namespace detail{
+		inline constexpr char BASE32_ALPHABET[32] = {
+			'0','1','2','3','4','5','6','7','8','9',
+			'A','B','C','D','E','F','G','H','J','K',
+			'M','N','P','Q','R','S','T','V','W','X',
+			'Y','Z'
+		};
+
+		// The source vector holds hi then lo, each in native little-endian byte order.
+		// Map big-endian byte index j (0 = most significant) to its position in that vector.
+		// Out-of-range indices map to 0x80, which both pshufb and tbl turn into a zero byte.
+		constexpr std::uint8_t be_byte_position(int j) noexcept{
+			if(j < 0 || j > 15){ return 0x80; }
+			return static_cast<std::uint8_t>(j < 8 ? 7 - j : 23 - j);
+		}
+
+		// Shuffle control for 32 16-bit lanes (26 digits + 6 padding lanes), 4 vectors of 16 bytes.
+		inline constexpr auto ENCODE_SHUFFLE = []{
+			std::array<std::uint8_t, 64> idx{};
+			for(int i = 0; i < 32; ++i){
+				if(i >= 26){
+					idx[2 * i] = idx[2 * i + 1] = 0x80;
+					continue;
+				}
+				const int b = 5 * i - 2;		  // first bit of digit i, may be -2 for the padding
+				const int j = (b + 8) / 8 - 1;	  // floor(b / 8) for b >= -8
+				idx[2 * i] = be_byte_position(j + 1); // low half of the lane
+				idx[2 * i + 1] = be_byte_position(j);	 // high half of the lane
+			}
+			return idx;
+		}();
+
+		// How far to shift each lane left so its digit lands in bits 15..11.
+		inline constexpr auto ENCODE_SHIFT = []{
+			std::array<std::int16_t, 32> shift{};
+			for(int i = 0; i < 26; ++i){
+				const int b = 5 * i - 2;
+				const int j = (b + 8) / 8 - 1;
+				shift[i] = static_cast<std::int16_t>(b - 8 * j);
+			}
+			return shift;
+		}();
+
+		// The same shifts as multipliers, for SSE/AVX2 which lack a variable 16-bit shift.
+		inline constexpr auto ENCODE_MULTIPLIER = []{
+			std::array<std::int16_t, 32> mul{};
+			for(int i = 0; i < 32; ++i){
+				mul[i] = static_cast<std::int16_t>(1 << ENCODE_SHIFT[i]);
+			}
+			return mul;
+		}();
+
+		inline std::size_t encode_many_scalar(std::span<const ulid_t> ids, char* out) noexcept{
+			for(const auto& id : ids){
+				id.to_chars(std::span<char, 26>{out, 26});
+				out += 26;
+			}
+			return ids.size();
+		}
+
+#if defined(ULID_SIMD_X86)
+		ULID_TARGET("sse4.1")
+		inline __m128i alphabet_lookup_sse41(__m128i digits) noexcept{
+			const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BASE32_ALPHABET));
+			const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(BASE32_ALPHABET + 16));
+			const __m128i is_high = _mm_cmpgt_epi8(digits, _mm_set1_epi8(15));
+			return _mm_blendv_epi8(_mm_shuffle_epi8(low, digits), _mm_shuffle_epi8(high, digits), is_high);
+		}
+
+		ULID_TARGET("sse4.1")
+		inline std::size_t encode_many_sse41(std::span<const ulid_t> ids, char* out) noexcept{
+			const auto* shuffle = reinterpret_cast<const __m128i*>(ENCODE_SHUFFLE.data());
+			const auto* multiplier = reinterpret_cast<const __m128i*>(ENCODE_MULTIPLIER.data());
+			const std::size_t end = ids.size() * 26;
+			std::size_t i = 0;
+			for(; i * 26 + 32 <= end; ++i){ // each id stores 32 bytes; the next id overwrites the tail, the scalar tail the last one
+				const auto [hi, lo] = ids[i].to_uint64s();
+				const __m128i v = _mm_set_epi64x(static_cast<long long>(lo), static_cast<long long>(hi));
+				__m128i lanes[4];
+				for(int k = 0; k < 4; ++k){
+					const __m128i window = _mm_shuffle_epi8(v, _mm_loadu_si128(shuffle + k));
+					lanes[k] = _mm_srli_epi16(_mm_mullo_epi16(window, _mm_loadu_si128(multiplier + k)), 11);
+				}
+				const __m128i first = alphabet_lookup_sse41(_mm_packus_epi16(lanes[0], lanes[1]));
+				const __m128i second = alphabet_lookup_sse41(_mm_packus_epi16(lanes[2], lanes[3]));
+				char* dst = out + i * 26;
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), first);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), second);
+			}
+			return i + encode_many_scalar(ids.subspan(i), out + i * 26);
+		}
+
+		ULID_TARGET("avx2")
+		inline __m256i alphabet_lookup_avx2(__m256i digits) noexcept{
+			const __m256i low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(BASE32_ALPHABET)));
+			const __m256i high = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(BASE32_ALPHABET + 16)));
+			const __m256i is_high = _mm256_cmpgt_epi8(digits, _mm256_set1_epi8(15));
+			return _mm256_blendv_epi8(_mm256_shuffle_epi8(low, digits), _mm256_shuffle_epi8(high, digits), is_high);
+		}
+
+		// Two ids per iteration: the first in the low 128-bit half, the second in the high half.
+		// vpshufb works within each half, so the SSE shuffle controls are simply broadcast.
+		ULID_TARGET("avx2")
+		inline std::size_t encode_many_avx2(std::span<const ulid_t> ids, char* out) noexcept{
+			const auto* shuffle = reinterpret_cast<const __m128i*>(ENCODE_SHUFFLE.data());
+			const auto* multiplier = reinterpret_cast<const __m128i*>(ENCODE_MULTIPLIER.data());
+			const std::size_t end = ids.size() * 26;
+			std::size_t i = 0;
+			for(; (i + 1) * 26 + 32 <= end; i += 2){ // as in SSE, never store past the last id
+				const auto [hi_a, lo_a] = ids[i].to_uint64s();
+				const auto [hi_b, lo_b] = ids[i + 1].to_uint64s();
+				const __m256i v = _mm256_set_epi64x(
+					static_cast<long long>(lo_b), static_cast<long long>(hi_b),
+					static_cast<long long>(lo_a), static_cast<long long>(hi_a));
+				__m256i lanes[4];
+				for(int k = 0; k < 4; ++k){
+					const __m256i control = _mm256_broadcastsi128_si256(_mm_loadu_si128(shuffle + k));
+					const __m256i mul = _mm256_broadcastsi128_si256(_mm_loadu_si128(multiplier + k));
+					lanes[k] = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_shuffle_epi8(v, control), mul), 11);
+				}
+				const __m256i first = alphabet_lookup_avx2(_mm256_packus_epi16(lanes[0], lanes[1]));  // [a 0..15 | b 0..15]
+				const __m256i second = alphabet_lookup_avx2(_mm256_packus_epi16(lanes[2], lanes[3])); // [a 16..31 | b 16..31]
+				char* dst = out + i * 26;
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(first, second, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 26), _mm256_permute2x128_si256(first, second, 0x31));
+			}
+			return i + encode_many_scalar(ids.subspan(i), out + i * 26);
+		}
+#endif
+
+#if defined(ULID_SIMD_NEON)
+		inline std::size_t encode_many_neon(std::span<const ulid_t> ids, char* out) noexcept{
+			const uint8x16x2_t alphabet = vld1q_u8_x2(reinterpret_cast<const std::uint8_t*>(BASE32_ALPHABET));
+			const std::size_t end = ids.size() * 26;
+			std::size_t i = 0;
+			for(; i * 26 + 32 <= end; ++i){
+				const auto [hi, lo] = ids[i].to_uint64s();
+				const uint8x16_t v = vcombine_u8(vcreate_u8(hi), vcreate_u8(lo));
+				uint8x8_t digits[4];
+				for(int k = 0; k < 4; ++k){
+					const uint8x16_t window = vqtbl1q_u8(v, vld1q_u8(ENCODE_SHUFFLE.data() + 16 * k));
+					const uint16x8_t shifted = vshlq_u16(vreinterpretq_u16_u8(window), vld1q_s16(ENCODE_SHIFT.data() + 8 * k));
+					digits[k] = vmovn_u16(vshrq_n_u16(shifted, 11));
+				}
+				char* dst = out + i * 26;
+				vst1q_u8(reinterpret_cast<std::uint8_t*>(dst), vqtbl2q_u8(alphabet, vcombine_u8(digits[0], digits[1])));
+				vst1q_u8(reinterpret_cast<std::uint8_t*>(dst + 16), vqtbl2q_u8(alphabet, vcombine_u8(digits[2], digits[3])));
+			}
+			return i + encode_many_scalar(ids.subspan(i), out + i * 26);
+		}
+#endif
+
+		// Crockford value of each letter 'A'..'Z' after case folding; 0xFF marks 'U', the one letter
+		// the alphabet leaves out entirely. Same mapping as ulid_t::decode_crockford().
+		inline constexpr auto LETTER_VALUES = []{
+			std::array<std::uint8_t, 32> table{};
+			for(auto& v : table){ v = 0xFF; }
+			for(std::uint8_t i = 10; i < 32; ++i){
+				table[BASE32_ALPHABET[i] - 'A'] = i;
+			}
+			table['O' - 'A'] = 0;
+			table['I' - 'A'] = 1;
+			table['L' - 'A'] = 1;
+			return table;
+		}();
+
+		// Moves digits 16..25 (lanes 6..15 of the second load, which starts at char 10) down to
+		// lanes 0..9 so they group into 4-digit words the same way the first load does.
+		alignas(16) inline constexpr std::uint8_t TAIL_ALIGN[16] = {
+			6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+		};
+
+		// Rebuilds hi/lo from seven 20-bit groups: g0..g3 hold digits 0..15, g4 and g5 hold
+		// digits 16..23, and g6 holds digits 24 and 25 followed by 10 zero bits.
+		inline ulid_t assemble_groups(const std::uint32_t (&g)[7]) noexcept{
+			const std::uint64_t hi = (std::uint64_t{g[0]} << 46) | (std::uint64_t{g[1]} << 26) | (std::uint64_t{g[2]} << 6) | (g[3] >> 14);
+			const std::uint64_t lo = (std::uint64_t{g[3]} << 50) | (std::uint64_t{g[4]} << 30) | (std::uint64_t{g[5]} << 10) | (g[6] >> 10);
+			return ulid_t::from_uint64s(hi, lo);
+		}
+
+		// Records one decode result; returns 1 if it was invalid.
+		inline std::size_t store_decoded(std::optional<ulid_t> id, std::size_t i, std::span<ulid_t> out, std::span<std::uint64_t> invalid) noexcept{
+			out[i] = id.value_or(ulid_t{});
+			if(id){ return 0; }
+			if(i / 64 < invalid.size()){
+				invalid[i / 64] |= std::uint64_t{1} << (i % 64);
+			}
+			return 1;
+		}
+
+		// A record the vector path rejected goes through from_string(), so metrics count its reason the
+		// same way on every level.
+		inline std::size_t store_rejected(const char* in, std::size_t i, std::span<ulid_t> out, std::span<std::uint64_t> invalid) noexcept{
+			return store_decoded(ulid_t::from_string(std::string_view{in + i * 26, 26}), i, out, invalid);
+		}
+
+		inline std::size_t decode_many_scalar(const char* in, std::size_t first, std::size_t count, std::span<ulid_t> out, std::span<std::uint64_t> invalid) noexcept{
+			std::size_t bad = 0;
+			for(std::size_t i = first; i < count; ++i){
+				bad += store_decoded(ulid_t::from_string(std::string_view{in + i * 26, 26}), i, out, invalid);
+			}
+			return bad;
+		}
+
+#if defined(ULID_SIMD_X86)
+		// Maps 16 chars to their Crockford values, or 0xFF where the char is not valid.
+		// Plain signed compares are safe: bytes >= 0x80 are negative and fail every range test.
+		ULID_TARGET("sse4.1")
+		inline __m128i crockford_values_sse41(__m128i c) noexcept{
+			const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+			const __m128i is_lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+			const __m128i upper = _mm_sub_epi8(c, _mm_and_si128(is_lower, _mm_set1_epi8(0x20))); // case folding
+			const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(upper, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(upper, _mm_set1_epi8('Z' + 1)));
+			const __m128i index = _mm_sub_epi8(upper, _mm_set1_epi8('A'));
+			const __m128i letters = _mm_blendv_epi8(
+				_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(LETTER_VALUES.data())), index),
+				_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(LETTER_VALUES.data() + 16)), index),
+				_mm_cmpgt_epi8(index, _mm_set1_epi8(15)));
+			const __m128i digits = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+			const __m128i value = _mm_blendv_epi8(_mm_set1_epi8(-1), letters, is_alpha);
+			return _mm_blendv_epi8(value, digits, is_digit);
+		}
+
+		// Folds 16 digit values into four 20-bit groups (4 digits each, most significant first).
+		ULID_TARGET("sse4.1")
+		inline __m128i group_digits_sse41(__m128i v) noexcept{
+			const __m128i pairs = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0120));	 // d[2k]*32 + d[2k+1]
+			return _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010400));			 // p[2k]*1024 + p[2k+1]
+		}
+
+		ULID_TARGET("sse4.1")
+		inline std::size_t decode_many_sse41(const char* in, std::size_t first, std::size_t count, std::span<ulid_t> out, std::span<std::uint64_t> invalid) noexcept{
+			const __m128i tail_align = _mm_load_si128(reinterpret_cast<const __m128i*>(TAIL_ALIGN));
+			const __m128i first_lane = _mm_cvtsi32_si128(0xFF);
+			std::size_t bad = 0;
+			for(std::size_t i = first; i < count; ++i){
+				const char* p = in + i * 26;
+				const __m128i head = crockford_values_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));		// chars 0..15
+				const __m128i tail = crockford_values_sse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 10)));	// chars 10..25
+				const __m128i overflow = _mm_cmpgt_epi8(_mm_and_si128(head, first_lane), _mm_set1_epi8(7)); // top 2 bits of digit 0
+				if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(head, tail), overflow)) != 0){
+					bad += store_rejected(in, i, out, invalid);
+					continue;
+				}
+				const __m128i g_head = group_digits_sse41(head);
+				const __m128i g_tail = group_digits_sse41(_mm_shuffle_epi8(tail, tail_align));
+				const std::uint32_t g[7] = {
+					static_cast<std::uint32_t>(_mm_extract_epi32(g_head, 0)), static_cast<std::uint32_t>(_mm_extract_epi32(g_head, 1)),
+					static_cast<std::uint32_t>(_mm_extract_epi32(g_head, 2)), static_cast<std::uint32_t>(_mm_extract_epi32(g_head, 3)),
+					static_cast<std::uint32_t>(_mm_extract_epi32(g_tail, 0)), static_cast<std::uint32_t>(_mm_extract_epi32(g_tail, 1)),
+					static_cast<std::uint32_t>(_mm_extract_epi32(g_tail, 2))
+				};
+				out[i] = assemble_groups(g);
+			}
+			return bad;
+		}
+
+		ULID_TARGET("avx2")
+		inline __m256i crockford_values_avx2(__m256i c) noexcept{
+			const __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+			const __m256i is_lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+			const __m256i upper = _mm256_sub_epi8(c, _mm256_and_si256(is_lower, _mm256_set1_epi8(0x20)));
+			const __m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(upper, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), upper));
+			const __m256i index = _mm256_sub_epi8(upper, _mm256_set1_epi8('A'));
+			const __m256i letters = _mm256_blendv_epi8(
+				_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(LETTER_VALUES.data()))), index),
+				_mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(LETTER_VALUES.data() + 16))), index),
+				_mm256_cmpgt_epi8(index, _mm256_set1_epi8(15)));
+			const __m256i digits = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+			const __m256i value = _mm256_blendv_epi8(_mm256_set1_epi8(-1), letters, is_alpha);
+			return _mm256_blendv_epi8(value, digits, is_digit);
+		}
+
+		ULID_TARGET("avx2")
+		inline __m256i load_pair_avx2(const char* low, const char* high) noexcept{
+			return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(low))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(high)), 1);
+		}
+
+		// Two records per iteration, one per 128-bit half, so all per-half logic matches SSE.
+		ULID_TARGET("avx2")
+		inline std::size_t decode_many_avx2(const char* in, std::size_t first, std::size_t count, std::span<ulid_t> out, std::span<std::uint64_t> invalid) noexcept{
+			const __m256i tail_align = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(TAIL_ALIGN)));
+			const __m256i first_lane = _mm256_set_epi32(0, 0, 0, 0xFF, 0, 0, 0, 0xFF);
+			const __m256i pair_weights = _mm256_set1_epi16(0x0120);
+			const __m256i group_weights = _mm256_set1_epi32(0x00010400);
+			std::size_t bad = 0;
+			std::size_t i = first;
+			for(; i + 1 < count; i += 2){
+				const char* p = in + i * 26;
+				const __m256i head = crockford_values_avx2(load_pair_avx2(p, p + 26));
+				const __m256i tail = crockford_values_avx2(load_pair_avx2(p + 10, p + 36));
+				const __m256i overflow = _mm256_cmpgt_epi8(_mm256_and_si256(head, first_lane), _mm256_set1_epi8(7));
+				const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(head, tail), overflow)));
+				const __m256i g_head = _mm256_madd_epi16(_mm256_maddubs_epi16(head, pair_weights), group_weights);
+				const __m256i g_tail = _mm256_madd_epi16(_mm256_maddubs_epi16(_mm256_shuffle_epi8(tail, tail_align), pair_weights), group_weights);
+				alignas(32) std::uint32_t heads[8];
+				alignas(32) std::uint32_t tails[8];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(heads), g_head);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(tails), g_tail);
+				for(std::size_t half = 0; half < 2; ++half){
+					if(((mask >> (16 * half)) & 0xFFFFu) != 0){
+						bad += store_rejected(in, i + half, out, invalid);
+						continue;
+					}
+					const std::uint32_t* h = heads + 4 * half;
+					const std::uint32_t* t = tails + 4 * half;
+					const std::uint32_t g[7] = {h[0], h[1], h[2], h[3], t[0], t[1], t[2]};
+					out[i + half] = assemble_groups(g);
+				}
+			}
+			return bad + decode_many_sse41(in, i, count, out, invalid); // odd record out, if any
+		}
+#endif
+
+#if defined(ULID_SIMD_NEON)
+		inline uint8x16_t crockford_values_neon(uint8x16_t c, uint8x16x2_t letter_values) noexcept{
+			const uint8x16_t digits = vsubq_u8(c, vdupq_n_u8('0'));
+			const uint8x16_t is_digit = vcltq_u8(digits, vdupq_n_u8(10));
+			const uint8x16_t is_lower = vcltq_u8(vsubq_u8(c, vdupq_n_u8('a')), vdupq_n_u8(26));
+			const uint8x16_t upper = vsubq_u8(c, vandq_u8(is_lower, vdupq_n_u8(0x20))); // case folding
+			const uint8x16_t index = vsubq_u8(upper, vdupq_n_u8('A'));
+			const uint8x16_t is_alpha = vcltq_u8(index, vdupq_n_u8(26));
+			const uint8x16_t value = vbslq_u8(is_alpha, vqtbl2q_u8(letter_values, index), vdupq_n_u8(0xFF));
+			return vbslq_u8(is_digit, digits, value);
+		}
+
+		// Folds 16 digit values into four 20-bit groups (4 digits each, most significant first).
+		inline uint32x4_t group_digits_neon(uint8x16_t v) noexcept{
+			const uint16x8_t bytes = vreinterpretq_u16_u8(v);
+			const uint16x8_t pairs = vorrq_u16(vshlq_n_u16(vandq_u16(bytes, vdupq_n_u16(0xFF)), 5), vshrq_n_u16(bytes, 8));
+			const uint32x4_t words = vreinterpretq_u32_u16(pairs);
+			return vorrq_u32(vshlq_n_u32(vandq_u32(words, vdupq_n_u32(0xFFFF)), 10), vshrq_n_u32(words, 16));
+		}
+
+		inline std::size_t decode_many_neon(const char* in, std::size_t first, std::size_t count, std::span<ulid_t> out, std::span<std::uint64_t> invalid) noexcept{
+			const uint8x16x2_t letter_values = vld1q_u8_x2(LETTER_VALUES.data());
+			const uint8x16_t tail_align = vld1q_u8(TAIL_ALIGN);
+			std::size_t bad = 0;
+			for(std::size_t i = first; i < count; ++i){
+				const auto* p = reinterpret_cast<const std::uint8_t*>(in + i * 26);
+				const uint8x16_t head = crockford_values_neon(vld1q_u8(p), letter_values);		// chars 0..15
+				const uint8x16_t tail = crockford_values_neon(vld1q_u8(p + 10), letter_values);	// chars 10..25
+				if((vmaxvq_u8(vorrq_u8(head, tail)) & 0x80u) != 0 || vgetq_lane_u8(head, 0) > 7){ // invalid char, or top 2 bits set
+					bad += store_rejected(in, i, out, invalid);
+					continue;
+				}
+				const uint32x4_t g_head = group_digits_neon(head);
+				const uint32x4_t g_tail = group_digits_neon(vqtbl1q_u8(tail, tail_align));
+				const std::uint32_t g[7] = {
+					vgetq_lane_u32(g_head, 0), vgetq_lane_u32(g_head, 1), vgetq_lane_u32(g_head, 2), vgetq_lane_u32(g_head, 3),
+					vgetq_lane_u32(g_tail, 0), vgetq_lane_u32(g_tail, 1), vgetq_lane_u32(g_tail, 2)
+				};
+				out[i] = assemble_groups(g);
+			}
+			return bad;
+		}
+#endif
+
+		inline simd_level detect_simd_level() noexcept{
+#if defined(ULID_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4]{};
+			__cpuid(info, 0);
+			const int max_leaf = info[0];
+			__cpuid(info, 1);
+			const bool sse41 = (info[2] & (1 << 19)) != 0;
+			const bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+			bool avx2 = false;
+			if(os_saves_ymm && max_leaf >= 7){
+				__cpuidex(info, 7, 0);
+				avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			__builtin_cpu_init();
+			const bool sse41 = __builtin_cpu_supports("sse4.1");
+			const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+			if(avx2){ return simd_level::avx2; }
+			if(sse41){ return simd_level::sse41; }
+			return simd_level::scalar;
+#elif defined(ULID_SIMD_NEON)
+			return simd_level::neon; // Advanced SIMD is mandatory on AArch64
+#else
+			return simd_level::scalar;
+#endif
+		}
+	} // namespace detail
+
+	// Detected once per process; the result never changes.
+	[[nodiscard]] inline simd_level detected_simd_level() noexcept{
+		static const simd_level level = detail::detect_simd_level();
+		return level;
+	}
+
+	[[nodiscard]] inline bool is_supported(simd_level level) noexcept{
+		const simd_level best = detected_simd_level();
+		switch(level){
+		case simd_level::scalar: return true;
+		case simd_level::sse41: return best == simd_level::sse41 || best == simd_level::avx2;
+		default: return level == best;
+		}
+	}
+
+	// Encode each id as 26 Crockford Base32 chars, back-to-back, into out.
+	// Encodes min(ids.size(), out.size() / 26) ids and returns that count. Bytes of out past the
+	// last id are never written, so out may be the front of a larger buffer.
+	// `level` selects a specific code path (e.g. for testing or benchmarking);
+	// levels the CPU does not support fall back to scalar.
+	inline std::size_t encode_many(std::span<const ulid_t> ids, std::span<char> out, simd_level level) noexcept{
+		if(ids.size() > out.size() / 26){
+			ids = ids.first(out.size() / 26);
+		}
+		if(!is_supported(level)){
+			level = simd_level::scalar;
+		}
+		switch(level){
+#if defined(ULID_SIMD_X86)
+		case simd_level::avx2: return detail::encode_many_avx2(ids, out.data());
+		case simd_level::sse41: return detail::encode_many_sse41(ids, out.data());
+#endif
+#if defined(ULID_SIMD_NEON)
+		case simd_level::neon: return detail::encode_many_neon(ids, out.data());
+#endif
+		default: return detail::encode_many_scalar(ids, out.data());
+		}
+	}
+
+	inline std::size_t encode_many(std::span<const ulid_t> ids, std::span<char> out) noexcept{
+		return encode_many(ids, out, detected_simd_level());
+	}
+
+	// Decode back-to-back 26-char records from packed into out, validating every record
+	// instead of stopping at the first bad one. Decodes min(packed.size() / 26, out.size()) records.
+	// Invalid records are written as ulid_t{} and, if `invalid` is large enough, flagged
+	// as bit (i % 64) of invalid[i / 64]. Returns the number of invalid records.
+	// Accepts exactly what ulid_t::from_string() accepts: lowercase, O -> 0, I/L -> 1.
+	inline std::size_t decode_many(std::span<const char> packed, std::span<ulid_t> out, std::span<std::uint64_t> invalid, simd_level level) noexcept{
+		const std::size_t count = std::min(packed.size() / 26, out.size());
+		for(std::size_t w = 0; w < invalid.size() && w * 64 < count; ++w){
+			invalid[w] = 0;
+		}
+		if(!is_supported(level)){
+			level = simd_level::scalar;
+		}
+		switch(level){
+#if defined(ULID_SIMD_X86)
+		case simd_level::avx2: return detail::decode_many_avx2(packed.data(), 0, count, out, invalid);
+		case simd_level::sse41: return detail::decode_many_sse41(packed.data(), 0, count, out, invalid);
+#endif
+#if defined(ULID_SIMD_NEON)
+		case simd_level::neon: return detail::decode_many_neon(packed.data(), 0, count, out, invalid);
+#endif
+		default: return detail::decode_many_scalar(packed.data(), 0, count, out, invalid);
+		}
+	}
+
+	inline std::size_t decode_many(std::span<const char> packed, std::span<ulid_t> out, std::span<std::uint64_t> invalid = {}) noexcept{
+		return decode_many(packed, out, invalid, detected_simd_level());
+	}
+} // namespace ulid
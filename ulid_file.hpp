@@ -0,0 +1,279 @@
+#pragma once
+#include "ulid.hpp"
+#include "ulid_algorithm.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ulid_file.hpp - memory-mapped files of sorted ULIDs.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::write_sorted_file(path, span<const ulid_t> sorted, index_stride = 4096)
+//       Write a sorted span to disk. Returns false on I/O failure or unsorted input.
+//
+//   - ulid::mapped_file::open(path) -> optional<mapped_file>
+//       mmap (POSIX) or MapViewOfFile (Windows) the file read-only and validate the header.
+//       ids() is a span<const ulid_t> straight over the mapping: no copy, no parse, so
+//       opening takes the same time for a thousand IDs or two billion.
+//
+// File layout:
+//   header      64 bytes, see file_header below
+//   records     count x 16 bytes at offset 64, sorted ascending
+//   index       optional: one uint64 timestamp_ms per index_stride records,
+//               index[k] = timestamp of record k * index_stride
+//
+// Records hold ulid_t's in-memory representation, hi word then lo word, in the byte order of
+// the machine that wrote the file; byte_order in the header records which one that was. On a
+// big-endian machine this is exactly the as_bytes() layout. A reader with the other byte order
+// rejects the file rather than converting, since a converted copy would defeat the mapping.
+//
+// The file contents are trusted: open() checks the header and sizes but does not re-verify the
+// sort order, which would mean touching every page.
+
+namespace ulid{
+
+	static_assert(sizeof(ulid_t) == 16 && alignof(ulid_t) <= 16, "mapped_file views records as ulid_t");
+	static_assert(std::is_trivially_copyable_v<ulid_t> && std::is_standard_layout_v<ulid_t>);
+
+	struct file_header final{
+		static constexpr std::array<char, 8> MAGIC{'U', 'L', 'I', 'D', 'S', 'O', 'R', 'T'};
+		static constexpr std::uint32_t VERSION = 1;
+		static constexpr std::uint32_t ENDIAN_TAG = 0x01020304; // reads back byte-swapped on the other endianness
+
+		std::array<char, 8> magic = MAGIC;
+		std::uint32_t version = VERSION;
+		std::uint32_t byte_order = ENDIAN_TAG;
+		std::uint64_t count = 0;			// number of records
+		std::uint64_t records_offset = 0;	// always sizeof(file_header) in version 1
+		std::uint64_t index_offset = 0;		// 0 when there is no index
+		std::uint64_t index_count = 0;
+		std::uint64_t index_stride = 0;
+		std::uint64_t reserved = 0;
+	};
+	static_assert(sizeof(file_header) == 64);
+
+	// index_stride == 0 writes no index.
+	[[nodiscard]] inline bool write_sorted_file(const std::filesystem::path& path, std::span<const ulid_t> sorted, std::size_t index_stride = 4096){
+		if(!std::is_sorted(sorted.begin(), sorted.end())){
+			return false;
+		}
+		file_header header{};
+		header.count = sorted.size();
+		header.records_offset = sizeof(file_header);
+		if(index_stride != 0 && !sorted.empty()){
+			header.index_offset = header.records_offset + sorted.size_bytes();
+			header.index_count = (sorted.size() + index_stride - 1) / index_stride;
+			header.index_stride = index_stride;
+		}
+#if defined(_WIN32)
+		std::FILE* raw = _wfopen(path.c_str(), L"wb");
+#else
+		std::FILE* raw = std::fopen(path.c_str(), "wb");
+#endif
+		if(raw == nullptr){
+			return false;
+		}
+		const std::unique_ptr<std::FILE, decltype(&std::fclose)> file{raw, &std::fclose};
+		bool ok = std::fwrite(&header, sizeof(header), 1, raw) == 1;
+		ok = ok && (sorted.empty() || std::fwrite(sorted.data(), sizeof(ulid_t), sorted.size(), raw) == sorted.size()); // an empty span may have no data()
+		for(std::size_t i = 0; ok && i < header.index_count; ++i){
+			const std::uint64_t ts = sorted[i * index_stride].timestamp_ms();
+			ok = std::fwrite(&ts, sizeof(ts), 1, raw) == 1;
+		}
+		return ok && std::fflush(raw) == 0;
+	}
+
+	class mapped_file final{
+	public:
+		mapped_file(const mapped_file&) = delete;
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept{ swap(other); }
+		mapped_file& operator=(mapped_file&& other) noexcept{
+			mapped_file tmp{std::move(other)};
+			swap(tmp);
+			return *this;
+		}
+		~mapped_file(){ unmap(); }
+
+		// std::nullopt if the file can't be mapped or is not a valid version-1 file for this machine.
+		[[nodiscard]] static std::optional<mapped_file> open(const std::filesystem::path& path) noexcept{
+			mapped_file f{};
+			if(!f.map(path) || !f.validate()){
+				return std::nullopt;
+			}
+			return f;
+		}
+
+		[[nodiscard]] const file_header& header() const noexcept{
+			return *reinterpret_cast<const file_header*>(base);
+		}
+
+		[[nodiscard]] std::span<const ulid_t> ids() const noexcept{ return records; }
+		[[nodiscard]] std::size_t size() const noexcept{ return records.size(); }
+		[[nodiscard]] bool empty() const noexcept{ return records.empty(); }
+		[[nodiscard]] std::span<const std::uint64_t> index() const noexcept{ return sparse_index; }
+
+		[[nodiscard]] bool contains(const ulid_t& id) const noexcept{
+			const auto same_ms = time_range(id.timestamp_ms(), id.timestamp_ms());
+			return std::binary_search(same_ms.begin(), same_ms.end(), id);
+		}
+
+		// IDs with t0 <= timestamp_ms() <= t1. Uses the sparse index, when present, to narrow
+		// each end to one stride before searching the records.
+		[[nodiscard]] std::span<const ulid_t> time_range(std::uint64_t t0, std::uint64_t t1) const noexcept{
+			if(t0 > t1){
+				return {};
+			}
+			const std::size_t first = lower_bound(t0);
+			const std::size_t last = t1 >= ulid_t::MAX_TIMESTAMP ? records.size() : lower_bound(t1 + 1);
+			return records.subspan(first, last - first);
+		}
+
+		// Index of the first record with timestamp_ms() >= ts.
+		[[nodiscard]] std::size_t lower_bound(std::uint64_t ts) const noexcept{
+			const auto window = search_window(ts);
+			const auto offset = static_cast<std::size_t>(window.data() - records.data());
+			return offset + detail::timestamp_lower_bound(window, ts);
+		}
+
+	private:
+		const std::byte* base = nullptr;
+		std::size_t length = 0;
+		std::span<const ulid_t> records{};
+		std::span<const std::uint64_t> sparse_index{};
+
+		mapped_file() noexcept = default;
+
+		void swap(mapped_file& other) noexcept{
+			std::swap(base, other.base);
+			std::swap(length, other.length);
+			std::swap(records, other.records);
+			std::swap(sparse_index, other.sparse_index);
+		}
+
+		// The stride of records that must hold the first timestamp >= ts; all of them without an index.
+		[[nodiscard]] std::span<const ulid_t> search_window(std::uint64_t ts) const noexcept{
+			if(sparse_index.empty()){
+				return records;
+			}
+			const std::size_t stride = static_cast<std::size_t>(header().index_stride);
+			const auto k = static_cast<std::size_t>(std::lower_bound(sparse_index.begin(), sparse_index.end(), ts) - sparse_index.begin());
+			// index[k - 1] < ts, so the answer is after record (k - 1) * stride; index[k] >= ts, so it is at most k * stride.
+			const std::size_t first = k == 0 ? 0 : (k - 1) * stride + 1;
+			const std::size_t last = std::min(records.size(), k * stride);
+			return records.subspan(first, last - first);
+		}
+
+		template<typename T>
+		[[nodiscard]] const T* view_as(std::uint64_t offset, std::uint64_t count) const noexcept{
+#if defined(__cpp_lib_start_lifetime_as)
+			return std::start_lifetime_as_array<T>(base + offset, count);
+#else
+			(void)count; // T is trivially copyable and implicit-lifetime; the mapping already holds its bytes
+			return std::launder(reinterpret_cast<const T*>(base + offset));
+#endif
+		}
+
+		[[nodiscard]] bool validate() noexcept{
+			if(length < sizeof(file_header)){
+				return false;
+			}
+			const file_header& h = header();
+			if(h.magic != file_header::MAGIC || h.version != file_header::VERSION
+				|| h.byte_order != file_header::ENDIAN_TAG || h.records_offset != sizeof(file_header)){
+				return false;
+			}
+			const std::uint64_t room = (length - sizeof(file_header)) / sizeof(ulid_t);
+			if(h.count > room){
+				return false;
+			}
+			const std::uint64_t records_end = h.records_offset + h.count * sizeof(ulid_t);
+			if(h.index_offset != 0){
+				if(h.index_stride == 0 || h.index_offset < records_end || h.index_offset % alignof(std::uint64_t) != 0
+					|| h.index_offset > length || h.index_count > (length - h.index_offset) / sizeof(std::uint64_t)
+					|| h.index_count != (h.count + h.index_stride - 1) / h.index_stride){
+					return false;
+				}
+				sparse_index = {view_as<std::uint64_t>(h.index_offset, h.index_count), static_cast<std::size_t>(h.index_count)};
+			}
+			records = {view_as<ulid_t>(h.records_offset, h.count), static_cast<std::size_t>(h.count)};
+			return true;
+		}
+
+#if defined(_WIN32)
+		[[nodiscard]] bool map(const std::filesystem::path& path) noexcept{
+			const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if(file == INVALID_HANDLE_VALUE){
+				return false;
+			}
+			LARGE_INTEGER size{};
+			if(!GetFileSizeEx(file, &size) || size.QuadPart == 0){
+				CloseHandle(file);
+				return false;
+			}
+			const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file); // the mapping keeps the file open
+			if(mapping == nullptr){
+				return false;
+			}
+			const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			CloseHandle(mapping); // and the view keeps the mapping alive
+			if(view == nullptr){
+				return false;
+			}
+			base = static_cast<const std::byte*>(view);
+			length = static_cast<std::size_t>(size.QuadPart);
+			return true;
+		}
+
+		void unmap() noexcept{
+			if(base != nullptr){
+				UnmapViewOfFile(base);
+			}
+		}
+#else
+		[[nodiscard]] bool map(const std::filesystem::path& path) noexcept{
+			const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if(fd < 0){
+				return false;
+			}
+			struct stat st{};
+			if(::fstat(fd, &st) != 0 || st.st_size <= 0){
+				::close(fd);
+				return false;
+			}
+			void* view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd); // the mapping keeps the file open
+			if(view == MAP_FAILED){
+				return false;
+			}
+			base = static_cast<const std::byte*>(view);
+			length = static_cast<std::size_t>(st.st_size);
+			return true;
+		}
+
+		void unmap() noexcept{
+			if(base != nullptr){
+				::munmap(const_cast<std::byte*>(base), length);
+			}
+		}
+#endif
+	};
+} // namespace ulid
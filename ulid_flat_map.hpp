@@ -0,0 +1,470 @@
+#pragma once
+#include "ulid.hpp"
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ULID_FLAT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ulid_flat_map.hpp - open-addressing hash map and set keyed on ULIDs.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::flat_map<V>
+//       ulid_t -> V without per-node allocations. Lookups probe 16 control bytes at a time.
+//
+//   - ulid::flat_set
+//       The same table without values.
+//
+// Layout (Swiss-table style):
+//   - one control byte per slot: EMPTY, DELETED, or the low 7 bits of the hash when full
+//   - keys in their own array of 16-byte ulid_t, values in a parallel array of V
+//   - slots are grouped 16 to a group; a probe loads a whole group of control bytes and
+//     compares them against the 7-bit tag with one SSE2 compare (scalar loop elsewhere)
+//   - groups are probed in triangular order over a power-of-two group count, and a probe
+//     stops at the first group holding an EMPTY byte. The table grows at 7/8 load.
+//
+// The hash is ulid::hasher (the random field) put through a multiply-and-fold finalizer, so
+// monotonic IDs, which differ only in their low bits, spread over the groups like random ones.
+// Memory per entry is (1 + 16 + sizeof(V)) / load_factor bytes: 25 bytes at full
+// load for V = uint64_t, versus 40+ bytes plus a malloc header per node for std::unordered_map.
+// See bench.cpp.
+//
+// V must be default constructible and move assignable. Inserting or erasing may rehash and
+// invalidates iterators and references; lookups never do. If an insert throws (bad_alloc, or V's
+// default constructor while growing), the map is unchanged.
+
+namespace ulid{
+
+	namespace detail{
+		struct no_value final{};
+
+		inline constexpr std::size_t GROUP_WIDTH = 16;
+		inline constexpr std::uint8_t CTRL_EMPTY = 0x80;
+		inline constexpr std::uint8_t CTRL_DELETED = 0xFE;
+
+		// Bit i set where ctrl[i] == tag.
+		inline std::uint32_t match_tag(const std::uint8_t* ctrl, std::uint8_t tag) noexcept{
+#if defined(ULID_FLAT_SSE2)
+			const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+			std::uint32_t mask = 0;
+			for(std::size_t i = 0; i < GROUP_WIDTH; ++i){
+				mask |= static_cast<std::uint32_t>(ctrl[i] == tag) << i;
+			}
+			return mask;
+#endif
+		}
+
+		inline std::uint32_t match_empty(const std::uint8_t* ctrl) noexcept{
+			return match_tag(ctrl, CTRL_EMPTY);
+		}
+
+		// EMPTY and DELETED are the only control bytes with the top bit set.
+		inline std::uint32_t match_free(const std::uint8_t* ctrl) noexcept{
+#if defined(ULID_FLAT_SSE2)
+			return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))));
+#else
+			std::uint32_t mask = 0;
+			for(std::size_t i = 0; i < GROUP_WIDTH; ++i){
+				mask |= static_cast<std::uint32_t>(ctrl[i] >> 7) << i;
+			}
+			return mask;
+#endif
+		}
+
+		// The storage and probing shared by flat_map and flat_set.
+		template<typename V>
+		class flat_table{
+		public:
+			static constexpr bool HAS_VALUES = !std::is_same_v<V, no_value>;
+			static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+			flat_table() noexcept = default;
+			flat_table(flat_table&& other) noexcept{ swap(other); }
+			flat_table& operator=(flat_table&& other) noexcept{
+				flat_table tmp{std::move(other)};
+				swap(tmp);
+				return *this;
+			}
+			flat_table(const flat_table& other){
+				if(other.slots == 0){ return; }
+				allocate(other.slots);
+				for(std::size_t i = 0; i < slots; ++i){
+					ctrl[i] = other.ctrl[i];
+					keys[i] = other.keys[i];
+					if constexpr(HAS_VALUES){ values[i] = other.values[i]; }
+				}
+				count = other.count;
+				growth_left = other.growth_left;
+			}
+			flat_table& operator=(const flat_table& other){
+				if(this != &other){
+					flat_table tmp{other};
+					swap(tmp);
+				}
+				return *this;
+			}
+
+			void swap(flat_table& other) noexcept{
+				std::swap(ctrl, other.ctrl);
+				std::swap(keys, other.keys);
+				std::swap(values, other.values);
+				std::swap(slots, other.slots);
+				std::swap(count, other.count);
+				std::swap(growth_left, other.growth_left);
+			}
+
+			[[nodiscard]] std::size_t size() const noexcept{ return count; }
+			[[nodiscard]] bool empty() const noexcept{ return count == 0; }
+			[[nodiscard]] std::size_t capacity() const noexcept{ return slots; }
+
+			// Heap bytes held by the table: control bytes, keys and values.
+			[[nodiscard]] std::size_t memory_bytes() const noexcept{
+				return slots * (1 + sizeof(ulid_t) + (HAS_VALUES ? sizeof(V) : 0));
+			}
+
+			void clear() noexcept{
+				for(std::size_t i = 0; i < slots; ++i){
+					if constexpr(HAS_VALUES){
+						if(is_full(i)){ values[i] = V{}; }
+					}
+					ctrl[i] = CTRL_EMPTY;
+				}
+				count = 0;
+				growth_left = max_load(slots);
+			}
+
+			// Make room for n entries without rehashing.
+			void reserve(std::size_t n){
+				if(n > count + growth_left){
+					rehash(slots_for(n));
+				}
+			}
+
+			[[nodiscard]] std::size_t find_index(const ulid_t& key) const noexcept{
+				if(count == 0){ return npos; }
+				const std::size_t h = hash_of(key);
+				const auto tag = static_cast<std::uint8_t>(h & 0x7F);
+				const std::size_t group_mask = slots / GROUP_WIDTH - 1;
+				std::size_t group = (h >> 7) & group_mask;
+				for(std::size_t step = 1;; ++step){
+					const std::uint8_t* c = ctrl.get() + group * GROUP_WIDTH;
+					for(auto m = match_tag(c, tag); m != 0; m &= m - 1){
+						const std::size_t i = group * GROUP_WIDTH + static_cast<std::size_t>(std::countr_zero(m));
+						if(keys[i] == key){ return i; }
+					}
+					if(match_empty(c) != 0){ return npos; }
+					group = (group + step) & group_mask;
+				}
+			}
+
+			// Returns {slot, inserted}. A new slot has its key set and a default value.
+			std::pair<std::size_t, bool> find_or_insert(const ulid_t& key){
+				if(const auto i = find_index(key); i != npos){
+					return {i, false};
+				}
+				if(slots == 0){
+					rehash(GROUP_WIDTH);
+				}
+				const std::size_t h = hash_of(key);
+				std::size_t i = free_slot(h);
+				if(ctrl[i] == CTRL_EMPTY){ // reusing a tombstone is always fine; a fresh slot counts against the load limit
+					if(growth_left == 0){
+						// Mostly tombstones: rebuild at the same size. Otherwise double.
+						rehash(count * 2 < max_load(slots) ? slots : slots * 2);
+						i = free_slot(h);
+					}
+					--growth_left;
+				}
+				ctrl[i] = static_cast<std::uint8_t>(h & 0x7F);
+				keys[i] = key;
+				++count;
+				return {i, true};
+			}
+
+			bool erase_key(const ulid_t& key) noexcept{
+				const auto i = find_index(key);
+				if(i == npos){ return false; }
+				erase_index(i);
+				return true;
+			}
+
+			void erase_index(std::size_t i) noexcept{
+				// If this group already has an EMPTY byte no probe ever walks past it,
+				// so the slot can go straight back to EMPTY instead of leaving a tombstone.
+				const std::uint8_t* group = ctrl.get() + (i / GROUP_WIDTH) * GROUP_WIDTH;
+				if(match_empty(group) != 0){
+					ctrl[i] = CTRL_EMPTY;
+					++growth_left;
+				} else{
+					ctrl[i] = CTRL_DELETED;
+				}
+				if constexpr(HAS_VALUES){ values[i] = V{}; } // release whatever the value holds now
+				--count;
+			}
+
+			[[nodiscard]] bool is_full(std::size_t i) const noexcept{ return (ctrl[i] & 0x80) == 0; }
+			[[nodiscard]] std::size_t next_full(std::size_t i) const noexcept{
+				while(i < slots && !is_full(i)){ ++i; }
+				return i;
+			}
+
+			[[nodiscard]] const ulid_t& key_at(std::size_t i) const noexcept{ return keys[i]; }
+			[[nodiscard]] V& value_at(std::size_t i) const noexcept{ return values[i]; }
+
+		private:
+			std::unique_ptr<std::uint8_t[]> ctrl;
+			std::unique_ptr<ulid_t[]> keys;
+			std::unique_ptr<V[]> values; // stays null for flat_set
+			std::size_t slots = 0;
+			std::size_t count = 0;
+			std::size_t growth_left = 0; // EMPTY slots we may still fill before hitting 7/8 load
+
+			static constexpr std::size_t max_load(std::size_t n) noexcept{ return n - n / 8; }
+
+			// ulid::hasher is close to the raw low random word, and IDs from generate_monotonic()
+			// differ only in its low bits, so runs of them would share a home group. One multiply
+			// spreads those bits up, and the fold brings the well-mixed high half back down to the
+			// bits the group and tag are taken from.
+			static std::size_t hash_of(const ulid_t& key) noexcept{
+				const std::uint64_t h = static_cast<std::uint64_t>(hasher{}(key)) * 0x9E3779B97F4A7C15ull;
+				return static_cast<std::size_t>(h ^ (h >> 32));
+			}
+
+			static std::size_t slots_for(std::size_t n) noexcept{
+				std::size_t s = GROUP_WIDTH;
+				while(max_load(s) < n){ s *= 2; }
+				return s;
+			}
+
+			void allocate(std::size_t n){
+				ctrl = std::make_unique<std::uint8_t[]>(n);
+				keys = std::make_unique<ulid_t[]>(n);
+				if constexpr(HAS_VALUES){ values = std::make_unique<V[]>(n); }
+				for(std::size_t i = 0; i < n; ++i){ ctrl[i] = CTRL_EMPTY; }
+				slots = n;
+				count = 0;
+				growth_left = max_load(n);
+			}
+
+			// First EMPTY or DELETED slot on h's probe sequence. The table is never full.
+			[[nodiscard]] std::size_t free_slot(std::size_t h) const noexcept{
+				const std::size_t group_mask = slots / GROUP_WIDTH - 1;
+				std::size_t group = (h >> 7) & group_mask;
+				for(std::size_t step = 1;; ++step){
+					if(const auto m = match_free(ctrl.get() + group * GROUP_WIDTH); m != 0){
+						return group * GROUP_WIDTH + static_cast<std::size_t>(std::countr_zero(m));
+					}
+					group = (group + step) & group_mask;
+				}
+			}
+
+			// Builds the new arrays next to the old ones and swaps them in only once every entry is
+			// across, so a bad_alloc leaves the table as it was. Values move unless their move can
+			// throw and they can be copied instead, as std::vector does.
+			void rehash(std::size_t new_slots){
+				flat_table fresh{};
+				fresh.allocate(new_slots);
+				for(std::size_t i = 0; i < slots; ++i){
+					if(!is_full(i)){ continue; }
+					const std::size_t h = hash_of(keys[i]);
+					const std::size_t j = fresh.free_slot(h);
+					fresh.ctrl[j] = static_cast<std::uint8_t>(h & 0x7F);
+					fresh.keys[j] = keys[i];
+					if constexpr(HAS_VALUES){
+						if constexpr(std::is_nothrow_move_assignable_v<V> || !std::is_copy_assignable_v<V>){
+							fresh.values[j] = std::move(values[i]);
+						} else{
+							fresh.values[j] = values[i];
+						}
+					}
+					++fresh.count;
+					--fresh.growth_left;
+				}
+				swap(fresh);
+			}
+		};
+	} // namespace detail
+
+	template<typename V>
+	class flat_map final{
+		using table_type = detail::flat_table<V>;
+	public:
+		using key_type = ulid_t;
+		using mapped_type = V;
+		using size_type = std::size_t;
+
+		template<bool Const>
+		class basic_iterator final{
+			using table_ptr = std::conditional_t<Const, const table_type*, table_type*>;
+			using mapped_ref = std::conditional_t<Const, const V&, V&>;
+		public:
+			using value_type = std::pair<const ulid_t&, mapped_ref>;
+			using difference_type = std::ptrdiff_t;
+
+			basic_iterator() noexcept = default;
+			basic_iterator(table_ptr table, std::size_t index) noexcept : table(table), index(index){}
+			operator basic_iterator<true>() const noexcept requires(!Const){ return {table, index}; }
+
+			[[nodiscard]] value_type operator*() const noexcept{
+				return {table->key_at(index), table->value_at(index)};
+			}
+			[[nodiscard]] const ulid_t& key() const noexcept{ return table->key_at(index); }
+			[[nodiscard]] mapped_ref value() const noexcept{ return table->value_at(index); }
+
+			basic_iterator& operator++() noexcept{
+				index = table->next_full(index + 1);
+				return *this;
+			}
+			basic_iterator operator++(int) noexcept{
+				auto tmp = *this;
+				++*this;
+				return tmp;
+			}
+			[[nodiscard]] bool operator==(const basic_iterator& other) const noexcept{ return index == other.index; }
+
+		private:
+			friend class flat_map;
+			table_ptr table = nullptr;
+			std::size_t index = 0;
+		};
+		using iterator = basic_iterator<false>;
+		using const_iterator = basic_iterator<true>;
+
+		flat_map() noexcept = default;
+		explicit flat_map(std::size_t expected){ table.reserve(expected); }
+
+		[[nodiscard]] size_type size() const noexcept{ return table.size(); }
+		[[nodiscard]] bool empty() const noexcept{ return table.empty(); }
+		[[nodiscard]] size_type capacity() const noexcept{ return table.capacity(); }
+		[[nodiscard]] size_type memory_bytes() const noexcept{ return table.memory_bytes(); }
+		void clear() noexcept{ table.clear(); }
+		void reserve(size_type n){ table.reserve(n); }
+
+		[[nodiscard]] iterator begin() noexcept{ return {&table, table.next_full(0)}; }
+		[[nodiscard]] iterator end() noexcept{ return {&table, table.capacity()}; }
+		[[nodiscard]] const_iterator begin() const noexcept{ return {&table, table.next_full(0)}; }
+		[[nodiscard]] const_iterator end() const noexcept{ return {&table, table.capacity()}; }
+
+		[[nodiscard]] iterator find(const ulid_t& key) noexcept{
+			const auto i = table.find_index(key);
+			return i == table_type::npos ? end() : iterator{&table, i};
+		}
+		[[nodiscard]] const_iterator find(const ulid_t& key) const noexcept{
+			const auto i = table.find_index(key);
+			return i == table_type::npos ? end() : const_iterator{&table, i};
+		}
+		[[nodiscard]] bool contains(const ulid_t& key) const noexcept{
+			return table.find_index(key) != table_type::npos;
+		}
+
+		// Inserts if absent; an existing value is left alone. Returns {position, inserted}.
+		std::pair<iterator, bool> insert(const ulid_t& key, V value){
+			const auto [i, inserted] = table.find_or_insert(key);
+			if(inserted){ table.value_at(i) = std::move(value); }
+			return {iterator{&table, i}, inserted};
+		}
+
+		std::pair<iterator, bool> insert_or_assign(const ulid_t& key, V value){
+			const auto [i, inserted] = table.find_or_insert(key);
+			table.value_at(i) = std::move(value);
+			return {iterator{&table, i}, inserted};
+		}
+
+		V& operator[](const ulid_t& key){
+			return table.value_at(table.find_or_insert(key).first);
+		}
+
+		// Returns the number of entries removed (0 or 1).
+		size_type erase(const ulid_t& key) noexcept{
+			return table.erase_key(key) ? 1 : 0;
+		}
+		void erase(const_iterator pos) noexcept{
+			table.erase_index(pos.index);
+		}
+
+	private:
+		table_type table;
+	};
+
+	class flat_set final{
+		using table_type = detail::flat_table<detail::no_value>;
+	public:
+		using key_type = ulid_t;
+		using value_type = ulid_t;
+		using size_type = std::size_t;
+
+		class const_iterator final{
+		public:
+			using value_type = ulid_t;
+			using difference_type = std::ptrdiff_t;
+
+			const_iterator() noexcept = default;
+			const_iterator(const table_type* table, std::size_t index) noexcept : table(table), index(index){}
+
+			[[nodiscard]] const ulid_t& operator*() const noexcept{ return table->key_at(index); }
+			[[nodiscard]] const ulid_t* operator->() const noexcept{ return &table->key_at(index); }
+			const_iterator& operator++() noexcept{
+				index = table->next_full(index + 1);
+				return *this;
+			}
+			const_iterator operator++(int) noexcept{
+				auto tmp = *this;
+				++*this;
+				return tmp;
+			}
+			[[nodiscard]] bool operator==(const const_iterator& other) const noexcept{ return index == other.index; }
+
+		private:
+			friend class flat_set;
+			const table_type* table = nullptr;
+			std::size_t index = 0;
+		};
+		using iterator = const_iterator;
+
+		flat_set() noexcept = default;
+		explicit flat_set(std::size_t expected){ table.reserve(expected); }
+
+		[[nodiscard]] size_type size() const noexcept{ return table.size(); }
+		[[nodiscard]] bool empty() const noexcept{ return table.empty(); }
+		[[nodiscard]] size_type capacity() const noexcept{ return table.capacity(); }
+		[[nodiscard]] size_type memory_bytes() const noexcept{ return table.memory_bytes(); }
+		void clear() noexcept{ table.clear(); }
+		void reserve(size_type n){ table.reserve(n); }
+
+		[[nodiscard]] const_iterator begin() const noexcept{ return {&table, table.next_full(0)}; }
+		[[nodiscard]] const_iterator end() const noexcept{ return {&table, table.capacity()}; }
+
+		[[nodiscard]] const_iterator find(const ulid_t& key) const noexcept{
+			const auto i = table.find_index(key);
+			return i == table_type::npos ? end() : const_iterator{&table, i};
+		}
+		[[nodiscard]] bool contains(const ulid_t& key) const noexcept{
+			return table.find_index(key) != table_type::npos;
+		}
+
+		std::pair<const_iterator, bool> insert(const ulid_t& key){
+			const auto [i, inserted] = table.find_or_insert(key);
+			return {const_iterator{&table, i}, inserted};
+		}
+
+		size_type erase(const ulid_t& key) noexcept{
+			return table.erase_key(key) ? 1 : 0;
+		}
+		void erase(const_iterator pos) noexcept{
+			table.erase_index(pos.index);
+		}
+
+	private:
+		table_type table;
+	};
+} // namespace ulid
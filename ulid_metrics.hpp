@@ -0,0 +1,220 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef ULID_INSTRUMENTATION
+#define ULID_INSTRUMENTATION 0
+#endif
+#if ULID_INSTRUMENTATION
+#include <mutex>
+#endif
+
+// ulid_metrics.hpp - optional counters for the generation and parsing hot paths.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+// Off by default. Build with ULID_INSTRUMENTATION=1 (the same value in every translation unit)
+// to turn it on; otherwise every hook below is an empty constexpr function and compiles away.
+//
+//   - ulid::metrics::snapshot() -> metrics::counters
+//       Totals since process start, summed over every thread that has generated or parsed,
+//       including threads that have since exited. Safe to call from any thread at any time,
+//       e.g. from a metrics scraper. Compute rates from the difference between two snapshots.
+//
+// Each thread counts into its own block of relaxed atomics, which it alone writes, so a hook is
+// a thread_local lookup plus a plain load and store: no locked instruction and no shared cache
+// line. A mutex is taken only when a thread counts for the first time, when it exits, and in
+// snapshot(). Counts are per event and read without a barrier, so a snapshot taken while other
+// threads are busy can be a few events behind.
+//
+// Hooks are skipped during constant evaluation, so constexpr parsing is not counted.
+
+namespace ulid::metrics{
+
+	inline constexpr bool enabled = ULID_INSTRUMENTATION != 0;
+
+	// Why from_string() or from_readable_string() returned std::nullopt.
+	enum class reject : std::uint8_t{
+		length,				// from_string: not 26 chars
+		character,			// from_string: a char outside the Crockford alphabet
+		overflow,			// from_string: first char above '7', more than 128 bits
+		readable_shape,		// from_readable_string: not 35 chars, or no 'T' / 'Z' separator
+		readable_field,		// from_readable_string: a non-digit, or a date or time out of range
+		readable_random,	// from_readable_string: an invalid char in the 16-char random tail
+		uuid,				// from_uuid_string: not 36 chars, a misplaced '-' or a non-hex digit
+	};
+	inline constexpr std::size_t REJECT_REASONS = 7;
+
+	struct counters final{
+		std::uint64_t generated = 0;				// IDs returned by a basic_generator or shared generator
+		std::uint64_t monotonic_increments = 0;		// monotonic IDs that reused the last timestamp and incremented the random field
+		std::uint64_t clock_regressions = 0;		// monotonic calls whose clock read was earlier than the last timestamp
+		std::uint64_t clock_regression_total_ms = 0;	// sum of how far back those reads were
+		std::uint64_t clock_regression_max_ms = 0;	// the largest single step back
+		std::uint64_t suffix_overflows = 0;			// increments that wrapped the random field (80 bits, 80 - K for node_generator<K>)
+		unsigned suffix_headroom_min_bits = 80;		// fewest bits of increment room left after any increment
+		std::array<std::uint64_t, REJECT_REASONS> rejected{};	// parse failures, indexed by metrics::reject
+
+		[[nodiscard]] constexpr std::uint64_t rejected_by(reject r) const noexcept{
+			return rejected[static_cast<std::size_t>(r)];
+		}
+	};
+
+	namespace detail{
+#if ULID_INSTRUMENTATION
+		enum slot : std::size_t{
+			GENERATED,
+			INCREMENTS,
+			REGRESSIONS,
+			REGRESSION_TOTAL_MS,
+			REGRESSION_MAX_MS,	// max, not sum
+			OVERFLOWS,
+			SUFFIX_USED_BITS,	// max of 80 - headroom, so every gauge aggregates by max
+			REJECTED,			// + metrics::reject
+			SLOTS = REJECTED + REJECT_REASONS,
+		};
+
+		constexpr bool is_max_slot(std::size_t s) noexcept{
+			return s == REGRESSION_MAX_MS || s == SUFFIX_USED_BITS;
+		}
+
+		struct thread_counters;
+
+		struct registry final{
+			std::mutex mutex;
+			thread_counters* head = nullptr;
+			std::array<std::uint64_t, SLOTS> retired{}; // folded in from exited threads
+
+			static registry& get() noexcept{
+				static registry r{};
+				return r;
+			}
+		};
+
+		struct thread_counters final{
+			std::array<std::atomic<std::uint64_t>, SLOTS> values{};
+			thread_counters* prev = nullptr;
+			thread_counters* next = nullptr;
+
+			thread_counters() noexcept{
+				registry& r = registry::get();
+				const std::scoped_lock lock{r.mutex};
+				next = r.head;
+				if(next != nullptr){ next->prev = this; }
+				r.head = this;
+			}
+			thread_counters(const thread_counters&) = delete;
+			thread_counters& operator=(const thread_counters&) = delete;
+			~thread_counters(){
+				registry& r = registry::get();
+				const std::scoped_lock lock{r.mutex};
+				collect(r.retired);
+				(prev != nullptr ? prev->next : r.head) = next;
+				if(next != nullptr){ next->prev = prev; }
+			}
+
+			// Only the owning thread writes, so load + store is enough; the atomics just make
+			// concurrent reads from snapshot() well-defined.
+			void add(std::size_t s, std::uint64_t n) noexcept{
+				values[s].store(values[s].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+			}
+			void raise(std::size_t s, std::uint64_t v) noexcept{
+				if(v > values[s].load(std::memory_order_relaxed)){
+					values[s].store(v, std::memory_order_relaxed);
+				}
+			}
+
+			void collect(std::array<std::uint64_t, SLOTS>& into) const noexcept{
+				for(std::size_t s = 0; s < SLOTS; ++s){
+					const std::uint64_t v = values[s].load(std::memory_order_relaxed);
+					into[s] = is_max_slot(s) ? (v > into[s] ? v : into[s]) : into[s] + v;
+				}
+			}
+
+			static thread_counters& local() noexcept{
+				static thread_local thread_counters instance{};
+				return instance;
+			}
+		};
+#endif
+
+		constexpr void count_generated() noexcept{
+#if ULID_INSTRUMENTATION
+			if !consteval{ thread_counters::local().add(GENERATED, 1); }
+#endif
+		}
+
+		// random_hi / random_lo are the incrementable field after the increment: the low hi_bits
+		// of hi (16, fewer under a node generator's node bits) and all of lo.
+		constexpr void count_increment(std::uint64_t random_hi, std::uint64_t random_lo, unsigned hi_bits = 16) noexcept{
+#if ULID_INSTRUMENTATION
+			if !consteval{
+				auto& c = thread_counters::local();
+				c.add(INCREMENTS, 1);
+				const std::uint64_t hi_mask = (std::uint64_t{1} << hi_bits) - 1;
+				const std::uint64_t room_hi = ~random_hi & hi_mask;
+				const unsigned headroom = room_hi != 0 ? 64 + static_cast<unsigned>(std::bit_width(room_hi)) : static_cast<unsigned>(std::bit_width(~random_lo));
+				c.raise(SUFFIX_USED_BITS, 80 - headroom);
+				if((random_hi & hi_mask) == 0 && random_lo == 0){
+					c.add(OVERFLOWS, 1);
+				}
+			}
+#else
+			(void)random_hi;
+			(void)random_lo;
+			(void)hi_bits;
+#endif
+		}
+
+		constexpr void count_clock_regression(std::uint64_t ms_back) noexcept{
+#if ULID_INSTRUMENTATION
+			if !consteval{
+				auto& c = thread_counters::local();
+				c.add(REGRESSIONS, 1);
+				c.add(REGRESSION_TOTAL_MS, ms_back);
+				c.raise(REGRESSION_MAX_MS, ms_back);
+			}
+#else
+			(void)ms_back;
+#endif
+		}
+
+		constexpr void count_rejected(reject r) noexcept{
+#if ULID_INSTRUMENTATION
+			if !consteval{ thread_counters::local().add(REJECTED + static_cast<std::size_t>(r), 1); }
+#else
+			(void)r;
+#endif
+		}
+	} // namespace detail
+
+	[[nodiscard]] inline counters snapshot(){
+		counters out{};
+#if ULID_INSTRUMENTATION
+		std::array<std::uint64_t, detail::SLOTS> sum{};
+		{
+			detail::registry& r = detail::registry::get();
+			const std::scoped_lock lock{r.mutex};
+			sum = r.retired;
+			for(const detail::thread_counters* c = r.head; c != nullptr; c = c->next){
+				c->collect(sum);
+			}
+		}
+		out.generated = sum[detail::GENERATED];
+		out.monotonic_increments = sum[detail::INCREMENTS];
+		out.clock_regressions = sum[detail::REGRESSIONS];
+		out.clock_regression_total_ms = sum[detail::REGRESSION_TOTAL_MS];
+		out.clock_regression_max_ms = sum[detail::REGRESSION_MAX_MS];
+		out.suffix_overflows = sum[detail::OVERFLOWS];
+		out.suffix_headroom_min_bits = 80 - static_cast<unsigned>(sum[detail::SUFFIX_USED_BITS]);
+		for(std::size_t i = 0; i < out.rejected.size(); ++i){
+			out.rejected[i] = sum[detail::REJECTED + i];
+		}
+#endif
+		return out;
+	}
+} // namespace ulid::metrics
@@ -0,0 +1,260 @@
+#pragma once
+#include "ulid.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// ulid_pack.hpp - compact columnar binary encoding for batches of ULIDs.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::pack(span<const ulid_t>[, pack_mode]) -> vector<std::byte>
+//   - ulid::pack(span<const ulid_t>, span<std::byte> out[, pack_mode]) -> optional<size_t>
+//       Encode a batch. The buffer form needs max_packed_size(n) bytes of room.
+//
+//   - ulid::unpack(span<const std::byte>) -> optional<vector<ulid_t>>
+//   - ulid::unpack(span<const std::byte>, span<ulid_t> out) -> optional<size_t>
+//       Decode a batch, optionally straight into a caller buffer. Malformed or truncated
+//       input returns std::nullopt; nothing is ever read past the end of the input.
+//
+// Format (version 1), all varints are unsigned LEB128:
+//   "UP" | version (1 byte) | flags (1 byte) | varint count
+//   timestamp column: varint ts[0], then varint zigzag(ts[i] - ts[i-1]) for the rest
+//   random column, one of:
+//     raw   (flags = 0): 10 bytes per ID, the 80 random bits big-endian
+//     delta (flags = 1): 10 raw bytes for the first ID, then per ID a varint v:
+//                        v = 0 -> 10 raw bytes follow; v > 0 -> random = previous + (v - 1)
+//
+// Nearly sorted timestamps cost 1-2 bytes each. IDs from generate_monotonic() within one
+// millisecond differ by 1 in the random field, so in delta mode they cost 2 bytes in total.
+// pack_mode::automatic picks whichever random column comes out smaller.
+
+namespace ulid{
+
+	enum class pack_mode : std::uint8_t{
+		automatic,
+		raw_random,
+		delta_random,
+	};
+
+	namespace detail{
+		inline constexpr std::byte PACK_MAGIC_0{'U'};
+		inline constexpr std::byte PACK_MAGIC_1{'P'};
+		inline constexpr std::byte PACK_VERSION{1};
+		inline constexpr std::uint8_t PACK_FLAG_DELTA = 1;
+		inline constexpr std::size_t PACK_HEADER_SIZE = 4;
+		inline constexpr std::size_t MAX_VARINT = 10;
+		inline constexpr std::size_t RANDOM_BYTES = 10;
+
+		constexpr std::size_t varint_size(std::uint64_t v) noexcept{
+			std::size_t n = 1;
+			while(v >= 0x80){
+				v >>= 7;
+				++n;
+			}
+			return n;
+		}
+
+		constexpr std::byte* write_varint(std::byte* out, std::uint64_t v) noexcept{
+			while(v >= 0x80){
+				*out++ = static_cast<std::byte>((v & 0x7F) | 0x80);
+				v >>= 7;
+			}
+			*out++ = static_cast<std::byte>(v);
+			return out;
+		}
+
+		// Bounds-checked reader over the packed input.
+		struct pack_reader{
+			const std::byte* pos;
+			const std::byte* end;
+
+			constexpr std::optional<std::uint64_t> varint() noexcept{
+				std::uint64_t v = 0;
+				for(unsigned shift = 0; shift < 64; shift += 7){
+					if(pos == end){
+						return std::nullopt;
+					}
+					const auto b = std::to_integer<std::uint64_t>(*pos++);
+					if(shift == 63 && b > 1){
+						return std::nullopt; // more than 64 bits
+					}
+					v |= (b & 0x7F) << shift;
+					if((b & 0x80) == 0){
+						return v;
+					}
+				}
+				return std::nullopt;
+			}
+
+			constexpr bool random(std::uint64_t& top, std::uint64_t& lo) noexcept{
+				if(end - pos < static_cast<std::ptrdiff_t>(RANDOM_BYTES)){
+					return false;
+				}
+				top = (std::to_integer<std::uint64_t>(pos[0]) << 8) | std::to_integer<std::uint64_t>(pos[1]);
+				lo = 0;
+				for(std::size_t i = 2; i < RANDOM_BYTES; ++i){
+					lo = (lo << 8) | std::to_integer<std::uint64_t>(pos[i]);
+				}
+				pos += RANDOM_BYTES;
+				return true;
+			}
+		};
+
+		constexpr std::byte* write_random(std::byte* out, std::uint64_t top, std::uint64_t lo) noexcept{
+			*out++ = static_cast<std::byte>(top >> 8);
+			*out++ = static_cast<std::byte>(top);
+			for(int shift = 56; shift >= 0; shift -= 8){
+				*out++ = static_cast<std::byte>(lo >> shift);
+			}
+			return out;
+		}
+
+		constexpr std::uint64_t zigzag(std::uint64_t delta) noexcept{
+			const auto d = static_cast<std::int64_t>(delta);
+			return (static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63);
+		}
+
+		constexpr std::uint64_t unzigzag(std::uint64_t v) noexcept{
+			return (v >> 1) ^ (~(v & 1) + 1);
+		}
+
+		// (b - a) over the 80-bit random field, if it is small enough to varint-encode as d + 1.
+		constexpr std::optional<std::uint64_t> small_random_delta(const ulid_t& a, const ulid_t& b) noexcept{
+			const auto [a_hi, a_lo] = a.to_uint64s();
+			const auto [b_hi, b_lo] = b.to_uint64s();
+			const std::uint64_t lo = b_lo - a_lo;
+			const std::uint64_t top = ((b_hi & 0xFFFFu) - (a_hi & 0xFFFFu) - (b_lo < a_lo ? 1 : 0)) & 0xFFFFu;
+			if(top != 0 || lo >= (std::uint64_t{1} << 63)){
+				return std::nullopt;
+			}
+			return lo;
+		}
+
+		constexpr std::size_t delta_random_size(std::span<const ulid_t> ids) noexcept{
+			std::size_t size = ids.empty() ? 0 : RANDOM_BYTES;
+			for(std::size_t i = 1; i < ids.size(); ++i){
+				const auto d = small_random_delta(ids[i - 1], ids[i]);
+				size += d ? varint_size(*d + 1) : 1 + RANDOM_BYTES;
+			}
+			return size;
+		}
+	} // namespace detail
+
+	// Upper bound on the packed size of n IDs, for sizing the buffer passed to pack().
+	[[nodiscard]] constexpr std::size_t max_packed_size(std::size_t n) noexcept{
+		return detail::PACK_HEADER_SIZE + detail::MAX_VARINT + n * (detail::MAX_VARINT + 1 + detail::RANDOM_BYTES);
+	}
+
+	// Returns the number of bytes written, or std::nullopt if `out` is smaller than max_packed_size().
+	[[nodiscard]] constexpr std::optional<std::size_t> pack(std::span<const ulid_t> ids, std::span<std::byte> out, pack_mode mode = pack_mode::automatic) noexcept{
+		if(out.size() < max_packed_size(ids.size())){
+			return std::nullopt;
+		}
+		if(mode == pack_mode::automatic){
+			mode = detail::delta_random_size(ids) < ids.size() * detail::RANDOM_BYTES ? pack_mode::delta_random : pack_mode::raw_random;
+		}
+		std::byte* p = out.data();
+		*p++ = detail::PACK_MAGIC_0;
+		*p++ = detail::PACK_MAGIC_1;
+		*p++ = detail::PACK_VERSION;
+		*p++ = static_cast<std::byte>(mode == pack_mode::delta_random ? detail::PACK_FLAG_DELTA : 0);
+		p = detail::write_varint(p, ids.size());
+
+		std::uint64_t previous_ts = 0;
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			const std::uint64_t ts = ids[i].timestamp_ms();
+			p = detail::write_varint(p, i == 0 ? ts : detail::zigzag(ts - previous_ts));
+			previous_ts = ts;
+		}
+		for(std::size_t i = 0; i < ids.size(); ++i){
+			const auto [hi, lo] = ids[i].to_uint64s();
+			if(mode == pack_mode::delta_random && i > 0){
+				if(const auto d = detail::small_random_delta(ids[i - 1], ids[i])){
+					p = detail::write_varint(p, *d + 1);
+					continue;
+				}
+				*p++ = std::byte{0};
+			}
+			p = detail::write_random(p, hi & 0xFFFFu, lo);
+		}
+		return static_cast<std::size_t>(p - out.data());
+	}
+
+	[[nodiscard]] inline std::vector<std::byte> pack(std::span<const ulid_t> ids, pack_mode mode = pack_mode::automatic){
+		std::vector<std::byte> out(max_packed_size(ids.size()));
+		out.resize(*pack(ids, out, mode));
+		return out;
+	}
+
+	// The ID count recorded in a packed header, or std::nullopt if the header is malformed.
+	[[nodiscard]] constexpr std::optional<std::size_t> packed_count(std::span<const std::byte> in) noexcept{
+		if(in.size() < detail::PACK_HEADER_SIZE || in[0] != detail::PACK_MAGIC_0 || in[1] != detail::PACK_MAGIC_1
+			|| in[2] != detail::PACK_VERSION || (std::to_integer<std::uint8_t>(in[3]) & ~detail::PACK_FLAG_DELTA) != 0){
+			return std::nullopt;
+		}
+		detail::pack_reader r{in.data() + detail::PACK_HEADER_SIZE, in.data() + in.size()};
+		const auto count = r.varint();
+		if(!count || *count > static_cast<std::uint64_t>(r.end - r.pos)){ // every ID takes at least one byte
+			return std::nullopt;
+		}
+		return static_cast<std::size_t>(*count);
+	}
+
+	// Decodes into out[0..count). Returns count, or std::nullopt if the input is malformed,
+	// has trailing bytes, or out is too small. On failure the contents of out are unspecified.
+	[[nodiscard]] constexpr std::optional<std::size_t> unpack(std::span<const std::byte> in, std::span<ulid_t> out) noexcept{
+		const auto count = packed_count(in);
+		if(!count || *count > out.size()){
+			return std::nullopt;
+		}
+		const bool delta = (std::to_integer<std::uint8_t>(in[3]) & detail::PACK_FLAG_DELTA) != 0;
+		detail::pack_reader r{in.data() + detail::PACK_HEADER_SIZE, in.data() + in.size()};
+		(void)r.varint(); // count, already validated
+
+		std::uint64_t ts = 0;
+		for(std::size_t i = 0; i < *count; ++i){ // timestamps land in hi for now; the random bits follow
+			const auto v = r.varint();
+			if(!v){ return std::nullopt; }
+			ts = i == 0 ? *v : ts + detail::unzigzag(*v);
+			if(ts > ulid_t::MAX_TIMESTAMP){ return std::nullopt; }
+			out[i] = ulid_t::from_uint64s(ts << 16, 0);
+		}
+		std::uint64_t top = 0;
+		std::uint64_t lo = 0;
+		for(std::size_t i = 0; i < *count; ++i){
+			if(delta && i > 0){
+				const auto v = r.varint();
+				if(!v){ return std::nullopt; }
+				if(*v != 0){
+					const std::uint64_t d = *v - 1;
+					lo += d;
+					top = (top + (lo < d ? 1 : 0)) & 0xFFFFu;
+					out[i] = ulid_t::from_uint64s(out[i].to_uint64s().first | top, lo);
+					continue;
+				}
+			}
+			if(!r.random(top, lo)){ return std::nullopt; }
+			out[i] = ulid_t::from_uint64s(out[i].to_uint64s().first | top, lo);
+		}
+		if(r.pos != r.end){
+			return std::nullopt;
+		}
+		return *count;
+	}
+
+	[[nodiscard]] inline std::optional<std::vector<ulid_t>> unpack(std::span<const std::byte> in){
+		const auto count = packed_count(in);
+		if(!count){
+			return std::nullopt;
+		}
+		std::vector<ulid_t> out(*count);
+		if(!unpack(in, out)){
+			return std::nullopt;
+		}
+		return out;
+	}
+} // namespace ulid
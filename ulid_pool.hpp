@@ -0,0 +1,180 @@
+#pragma once
+#include "ulid.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+
+// ulid_pool.hpp - IDs generated ahead of time, so request threads only pop them.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::prefetch_pool (basic_prefetch_pool<Engine, Clock>)
+//       A bounded single-producer / multi-consumer ring of ready IDs:
+//
+//         ulid::prefetch_pool pool{{.capacity = 4096, .max_age_ms = 5}};
+//         auto id = pool.pop();       // any thread: one CAS on the ring head
+//
+//       With refill_mode::background (the default) a jthread tops the ring up every
+//       refill_period. With refill_mode::manual nothing runs on its own; call refill() from your
+//       executor, e.g. a periodic coroutine task. Only one thread at a time may call refill().
+//
+// The producer fills the ring with generate_monotonic_n(), so its IDs are strictly increasing in
+// ring order, and pops hand them out in that order. Staleness: try_pop() never returns an ID whose
+// timestamp is more than max_age_ms behind Clock::now_ms(); stale IDs are dropped, by consumers
+// and by each refill(). pop() falls back to ulid_t::generate_monotonic<Clock>() when the ring is
+// empty or stale; that ID is unique and fresh but not ordered against the ring's.
+//
+// Size the ring for the peak pop rate over one refill_period. The default Clock, cached_ms_clock,
+// keeps the staleness check to one relaxed load. The ring holds no process-wide state, but the
+// background thread does not survive fork(): create pools after forking.
+
+namespace ulid{
+
+	enum class refill_mode : std::uint8_t{
+		background,	// a jthread owned by the pool calls refill() every refill_period
+		manual,		// the owner calls refill()
+	};
+
+	struct pool_options final{
+		std::size_t capacity = 1024;		// rounded up to a power of two
+		std::uint64_t max_age_ms = 5;		// oldest timestamp try_pop() will hand out, relative to Clock::now_ms()
+		refill_mode mode = refill_mode::background;
+		std::chrono::microseconds refill_period{500};
+	};
+
+	template<typename Engine = RomuDuoJr, ms_clock Clock = cached_ms_clock>
+	class basic_prefetch_pool final{
+	public:
+		using generator_type = basic_generator<Engine, Clock>;
+
+		explicit basic_prefetch_pool(pool_options options = {})
+			: slots(std::make_unique<slot[]>(ring_size(options.capacity)))
+			, mask(ring_size(options.capacity) - 1)
+			, max_age(options.max_age_ms){
+			refill();
+			if(options.mode == refill_mode::background){
+				producer = std::jthread{[this, period = options.refill_period](std::stop_token stop){
+					while(!stop.stop_requested()){
+						std::this_thread::sleep_for(period);
+						refill();
+					}
+				}};
+			}
+		}
+		basic_prefetch_pool(const basic_prefetch_pool&) = delete; // the producer thread holds `this`
+		basic_prefetch_pool& operator=(const basic_prefetch_pool&) = delete;
+
+		// The oldest fresh ID in the ring, or std::nullopt if there is none. Lock-free.
+		[[nodiscard]] std::optional<ulid_t> try_pop() noexcept{
+			return pop_fresh(Clock::now_ms());
+		}
+
+		// try_pop(), or a freshly generated ID when the ring has run dry.
+		[[nodiscard]] ulid_t pop() noexcept{
+			if(const auto id = try_pop()){
+				return *id;
+			}
+			return ulid_t::generate_monotonic<Clock>();
+		}
+
+		// Drops stale IDs and fills every free slot, all stamped with one clock read.
+		// Returns the number of IDs added. Producer side: one caller at a time.
+		std::size_t refill() noexcept{
+			const std::uint64_t now = Clock::now_ms();
+			drop_stale(now);
+			std::uint64_t t = tail.load(std::memory_order_relaxed);
+			const std::size_t room = capacity() - static_cast<std::size_t>(t - head.load(std::memory_order_acquire));
+			std::array<ulid_t, 64> batch{};
+			for(std::size_t done = 0; done < room;){
+				const std::size_t n = room - done < batch.size() ? room - done : batch.size();
+				gen.generate_monotonic_n(std::span{batch.data(), n}, now);
+				for(std::size_t i = 0; i < n; ++i){
+					const auto [hi, lo] = batch[i].to_uint64s();
+					slot& s = slots[(t + i) & mask];
+					s.hi.store(hi, std::memory_order_relaxed);
+					s.lo.store(lo, std::memory_order_relaxed);
+				}
+				t += n;
+				tail.store(t, std::memory_order_release); // publish each batch as soon as it is written
+				done += n;
+			}
+			return room;
+		}
+
+		[[nodiscard]] std::size_t capacity() const noexcept{ return mask + 1; }
+		[[nodiscard]] std::uint64_t max_age_ms() const noexcept{ return max_age; }
+		// IDs in the ring right now, stale or not; only a hint while other threads pop.
+		[[nodiscard]] std::size_t size() const noexcept{
+			const std::uint64_t h = head.load(std::memory_order_acquire);
+			return static_cast<std::size_t>(tail.load(std::memory_order_acquire) - h);
+		}
+
+	private:
+		// Relaxed atomics, so a consumer that reads a slot just as it is reused (and then loses its
+		// CAS) is not a data race. The tail's release / acquire orders the contents.
+		struct slot final{
+			std::atomic<std::uint64_t> hi{0};
+			std::atomic<std::uint64_t> lo{0};
+		};
+
+		std::unique_ptr<slot[]> slots;
+		std::size_t mask;
+		std::uint64_t max_age;
+		generator_type gen{};
+		alignas(64) std::atomic<std::uint64_t> head{0};	// next slot to pop; consumers CAS it forward
+		alignas(64) std::atomic<std::uint64_t> tail{0};	// next slot to fill; producer only
+		std::jthread producer{};						// last, so it is stopped before the ring goes away
+
+		static std::size_t ring_size(std::size_t capacity) noexcept{
+			return std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity);
+		}
+
+		// A clock that lags the producer's (now < timestamp) reads as fresh.
+		[[nodiscard]] bool is_stale(const ulid_t& id, std::uint64_t now) const noexcept{
+			const std::uint64_t ts = id.timestamp_ms();
+			return now > ts && now - ts > max_age;
+		}
+
+		[[nodiscard]] ulid_t read_slot(std::uint64_t i) const noexcept{
+			const slot& s = slots[i & mask];
+			return ulid_t::from_uint64s(s.hi.load(std::memory_order_relaxed), s.lo.load(std::memory_order_relaxed));
+		}
+
+		// Producer side: moves the head past stale IDs, stopping at the first fresh one. The ring
+		// is in timestamp order, so everything behind that one is fresh too.
+		void drop_stale(std::uint64_t now) noexcept{
+			std::uint64_t h = head.load(std::memory_order_relaxed);
+			while(h != tail.load(std::memory_order_relaxed) && is_stale(read_slot(h), now)){
+				if(head.compare_exchange_weak(h, h + 1, std::memory_order_release, std::memory_order_relaxed)){
+					++h;
+				}
+			}
+		}
+
+		// Claims slots from the head until one holds a fresh ID. The slot can only be refilled once
+		// the head has moved past it, so a successful CAS proves the ID read before it was intact.
+		[[nodiscard]] std::optional<ulid_t> pop_fresh(std::uint64_t now) noexcept{
+			std::uint64_t h = head.load(std::memory_order_relaxed);
+			while(h != tail.load(std::memory_order_acquire)){
+				const ulid_t id = read_slot(h);
+				if(head.compare_exchange_weak(h, h + 1, std::memory_order_release, std::memory_order_relaxed)){
+					if(!is_stale(id, now)){
+						return id;
+					}
+					++h; // dropped; try the next one
+				}
+			}
+			return std::nullopt;
+		}
+	};
+
+	using prefetch_pool = basic_prefetch_pool<>;
+} // namespace ulid
@@ -0,0 +1,241 @@
+#pragma once
+#include "ulid.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+// ulid_shared.hpp - process-wide monotonic ULID generation.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::shared_generator (basic_shared_generator<Engine, Clock>)
+//       One generator shared by any number of threads. IDs are strictly increasing across
+//       all callers, not just within a thread. The whole 128-bit last value is updated with a
+//       single compare-and-swap (cmpxchg16b / _InterlockedCompareExchange128), so callers never
+//       block: a failed CAS simply retries on top of the value that won.
+//
+//   - ulid::block_generator (basic_block_generator<Engine, Clock>)
+//       Threads reserve blocks of the random suffix (2^16 by default) with one CAS each, then
+//       count through them locally. Unique across threads and ordered within each thread;
+//       time-ordered but not strictly monotonic across threads. Scales with core count.
+//
+// The state sits alone on its own cache line to keep unrelated data from bouncing with it.
+// The CAS itself still serializes all callers on that one line; see bench.cpp for how it scales.
+//
+// fork() copies the shared state into the child. Their thread-local generators reseed in the child
+// (see ulid::seeding), but both processes continue from the same last value until the next
+// millisecond with fresh randomness; a child that needs IDs immediately should use its own generator.
+
+namespace ulid{
+
+	namespace detail{
+		struct alignas(16) u128_words{
+			std::uint64_t hi = 0; // same order as ulid_t::to_uint64s()
+			std::uint64_t lo = 0;
+		};
+
+		// 128-bit compare-and-swap. On failure `expected` is updated to the current value.
+		inline bool cas_128(u128_words* target, u128_words& expected, u128_words desired) noexcept{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			// The intrinsic names the qword at offset 8 "high" and the one at offset 0 "low".
+			return _InterlockedCompareExchange128(reinterpret_cast<volatile long long*>(target),
+				static_cast<long long>(desired.lo), static_cast<long long>(desired.hi),
+				reinterpret_cast<long long*>(&expected)) != 0;
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+			// Inline asm rather than __atomic builtins: without -mcx16 those call into libatomic.
+			// cmpxchg16b compares rdx:rax with the 16 bytes at target (rax = offset 0) and,
+			// if equal, stores rcx:rbx; otherwise it loads the current value into rdx:rax.
+			bool swapped = false;
+			__asm__ __volatile__("lock cmpxchg16b %1"
+				: "=@ccz"(swapped), "+m"(*target), "+a"(expected.hi), "+d"(expected.lo)
+				: "b"(desired.hi), "c"(desired.lo)
+				: "memory");
+			return swapped;
+#else
+			// Lock-free where the target has a 16-byte CAS (e.g. AArch64 with LSE).
+			return std::atomic_ref<u128_words>(*target).compare_exchange_weak(expected, desired,
+				std::memory_order_acq_rel, std::memory_order_acquire);
+#endif
+		}
+
+		// Adds n to the 80-bit random field (the low 16 bits of hi and all of lo). Wraps within 80 bits.
+		constexpr void add_80(u128_words& v, std::uint64_t n) noexcept{
+			v.lo += n;
+			if(v.lo < n){ // carry into the top 16 random bits, leaving the timestamp alone
+				v.hi = (v.hi & ~std::uint64_t{0xFFFF}) | ((v.hi + 1) & 0xFFFF);
+			}
+		}
+
+		inline constexpr std::size_t CACHE_LINE = 64;
+	} // namespace detail
+
+	template<typename Engine = RomuDuoJr, ms_clock Clock = system_ms_clock>
+	class basic_shared_generator final{
+	public:
+		basic_shared_generator() noexcept = default;
+		basic_shared_generator(const basic_shared_generator&) = delete;
+		basic_shared_generator& operator=(const basic_shared_generator&) = delete;
+
+		// A process-wide instance, for when one shared sequence is all you need.
+		[[nodiscard]] static basic_shared_generator& instance() noexcept{
+			static basic_shared_generator shared{};
+			return shared;
+		}
+
+		// Strictly greater than every ULID previously returned by this generator, on any thread.
+		// Same rules as generate_monotonic(): a new millisecond gets fresh randomness, otherwise
+		// (same millisecond or clock rollback) the random field of the last value is incremented.
+		[[nodiscard]] ulid_t generate_monotonic() noexcept{
+			return generate_monotonic(Clock::now_ms());
+		}
+
+		[[nodiscard]] ulid_t generate_monotonic(std::uint64_t ts) noexcept{
+			auto& rng = thread_generator().prng();
+			detail::u128_words expected = last_seen(); // a stale guess is fine: the first CAS corrects it
+			for(;;){
+				detail::u128_words desired{};
+				if(ts > (expected.hi >> 16)){
+					desired = fresh(rng, ts);
+				} else{
+					desired = expected;
+					detail::add_80(desired, 1);
+				}
+				if(detail::cas_128(&state, expected, desired)){
+					last_seen() = desired;
+					metrics::detail::count_generated(); // once per returned ID, whichever path won
+					const std::uint64_t last_ts = expected.hi >> 16;
+					if(ts <= last_ts){
+						if(ts < last_ts){
+							metrics::detail::count_clock_regression(last_ts - ts);
+						}
+						metrics::detail::count_increment(desired.hi & 0xFFFF, desired.lo);
+					}
+					return ulid_t::from_uint64s(desired.hi, desired.lo);
+				}
+			}
+		}
+
+	private:
+		using prng_type = typename basic_generator<Engine, Clock>::prng_type;
+
+		alignas(detail::CACHE_LINE) detail::u128_words state{};
+		[[maybe_unused]] char padding[detail::CACHE_LINE - sizeof(detail::u128_words)]{};
+
+		static basic_generator<Engine, Clock>& thread_generator() noexcept{
+			static thread_local basic_generator<Engine, Clock> local{};
+			static thread_local std::uint64_t epoch = seeding::epoch();
+			if(const std::uint64_t now = seeding::epoch(); now != epoch) [[unlikely]]{
+				epoch = now;
+				local.reseed();
+			}
+			return local;
+		}
+
+		// A new millisecond's first ID, drawn straight from the engine: a CAS that loses must not
+		// have counted anything. Same bits as basic_generator::generate(ts).
+		static detail::u128_words fresh(prng_type& rng, std::uint64_t ts) noexcept{
+			const std::uint64_t top = rng.template bits<16>();
+			std::uint64_t low = rng.next();
+			if constexpr(prng_type::BITS == 32){
+				low = (low << 32) | rng.next();
+			}
+			return {(ts << 16) | top, low}; // the shift drops everything above 48 bits
+		}
+
+		// This thread's last result, used as the first CAS guess. Shared across instances
+		// on purpose: it is only ever a hint.
+		static detail::u128_words& last_seen() noexcept{
+			static thread_local detail::u128_words hint{};
+			return hint;
+		}
+	};
+
+	using shared_generator = basic_shared_generator<>;
+
+	// Hands out the 80-bit random suffix in reserved blocks, so threads touch the shared cache line
+	// once per block instead of once per ID. Each thread owns a `local`, which reserves a contiguous
+	// range of block_size suffixes for the current millisecond with one CAS, then counts through it
+	// with plain increments.
+	//
+	// Guarantees: IDs are unique across all threads, and strictly increasing within each `local`.
+	// Across threads they are time-ordered at millisecond precision, but not strictly monotonic:
+	// two threads interleave their blocks.
+	//
+	//   auto& shared = ulid::block_generator::instance();
+	//   thread_local ulid::block_generator::local ids{shared};
+	//   auto id = ids.generate();
+	template<typename Engine = RomuDuoJr, ms_clock Clock = system_ms_clock>
+	class basic_block_generator final{
+	public:
+		static constexpr std::uint64_t DEFAULT_BLOCK_SIZE = std::uint64_t{1} << 16;
+
+		explicit basic_block_generator(std::uint64_t block_size = DEFAULT_BLOCK_SIZE) noexcept
+			: block_size(block_size != 0 ? block_size : 1){}
+		basic_block_generator(const basic_block_generator&) = delete;
+		basic_block_generator& operator=(const basic_block_generator&) = delete;
+
+		[[nodiscard]] static basic_block_generator& instance() noexcept{
+			static basic_block_generator shared{};
+			return shared;
+		}
+
+		[[nodiscard]] std::uint64_t reservation_size() const noexcept{ return block_size; }
+
+		// Per-thread handle. Not thread-safe itself; give each thread its own.
+		class local final{
+		public:
+			explicit local(basic_block_generator& shared) noexcept : shared(&shared){}
+
+			[[nodiscard]] ulid_t generate() noexcept{
+				return generate(Clock::now_ms());
+			}
+
+			[[nodiscard]] ulid_t generate(std::uint64_t ts) noexcept{
+				if(remaining == 0 || ts > block_ts){ // block used up, or a new millisecond began
+					next = shared->reserve(ts, source);
+					block_ts = next.hi >> 16;
+					remaining = shared->block_size;
+				}
+				const ulid_t id = ulid_t::from_uint64s(next.hi, next.lo);
+				detail::add_80(next, 1);
+				--remaining;
+				return id;
+			}
+
+		private:
+			basic_block_generator* shared;
+			basic_generator<Engine, Clock> source{}; // randomness for the first block of each millisecond
+			detail::u128_words next{};
+			std::uint64_t block_ts = 0;
+			std::uint64_t remaining = 0;
+		};
+
+	private:
+		alignas(detail::CACHE_LINE) detail::u128_words cursor{}; // first unreserved suffix of the newest millisecond
+		[[maybe_unused]] char padding[detail::CACHE_LINE - sizeof(detail::u128_words)]{};
+		std::uint64_t block_size;
+
+		// Returns the first ULID of a fresh block of block_size IDs.
+		detail::u128_words reserve(std::uint64_t ts, basic_generator<Engine, Clock>& source) noexcept{
+			detail::u128_words expected{}; // wrong on purpose; the first failed CAS loads the real cursor
+			for(;;){
+				detail::u128_words base = expected;
+				if(ts > (expected.hi >> 16)){ // first reservation in a new millisecond starts at a random point
+					const auto [hi, lo] = source.generate(ts).to_uint64s();
+					base = {hi & ~std::uint64_t{0x8000}, lo}; // clear the top random bit: 2^79 IDs of headroom before the suffix could wrap
+				}
+				detail::u128_words desired = base;
+				detail::add_80(desired, block_size);
+				if(detail::cas_128(&cursor, expected, desired)){
+					return base;
+				}
+			}
+		}
+	};
+
+	using block_generator = basic_block_generator<>;
+} // namespace ulid
@@ -0,0 +1,190 @@
+#pragma once
+#include "ulid.hpp"
+#include "ulid_batch.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ULID_STREAM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ulid_stream.hpp - chunked parsing of delimited text that starts each record with a ULID.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+//   - ulid::stream_parser
+//       Feed it chunks of any size as they arrive from a file or socket:
+//
+//         ulid::stream_parser parser{};
+//         while(auto chunk = read_some()){
+//             parser.feed(chunk, [](const ulid::ulid_t& id, std::string_view line){ ... });
+//         }
+//         parser.finish(sink); // the last record, if the input doesn't end with a delimiter
+//
+//       Each record is one line (the delimiter, '\n' by default, and a trailing '\r' are
+//       stripped). Its first field, up to the first ',', '\t' or ' ', must be a 26-char
+//       canonical ULID or the 35-char readable form. Valid records go to the sink with their
+//       full line; the rest are counted in invalid(). Empty lines are skipped.
+//
+// Delimiters are found 16 bytes at a time with SSE2 (memchr elsewhere). Canonical IDs are
+// gathered 64 at a time and validated with ulid::decode_many(), so they get the vector decoder.
+// The line views passed to the sink point into the chunk, or into an internal carry buffer for a
+// record split across chunks; they are only valid during the call. Nothing is allocated per
+// record: the carry buffer grows to the longest split line and is then reused.
+
+namespace ulid{
+
+	namespace detail{
+		// First occurrence of c in [first, last), or last.
+		inline const char* find_char(const char* first, const char* last, char c) noexcept{
+#if defined(ULID_STREAM_SSE2)
+			const __m128i needle = _mm_set1_epi8(c);
+			for(; last - first >= 16; first += 16){
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+				const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+				if(mask != 0){
+					return first + std::countr_zero(static_cast<unsigned>(mask));
+				}
+			}
+			for(; first != last; ++first){
+				if(*first == c){ return first; }
+			}
+			return last;
+#else
+			const void* hit = first == last ? nullptr : std::memchr(first, c, static_cast<std::size_t>(last - first));
+			return hit != nullptr ? static_cast<const char*>(hit) : last;
+#endif
+		}
+
+		constexpr bool is_field_separator(char c) noexcept{
+			return c == ',' || c == '\t' || c == ' ';
+		}
+	} // namespace detail
+
+	class stream_parser final{
+	public:
+		explicit stream_parser(char delimiter = '\n') noexcept : delimiter(delimiter){}
+
+		// Parse every complete record in chunk. A trailing partial record is kept for the next call.
+		// sink is called as sink(const ulid_t&, std::string_view line), in input order.
+		template<typename Sink>
+		void feed(std::span<const char> chunk, Sink&& sink){
+			const char* p = chunk.data();
+			const char* const end = p + chunk.size();
+			if(!carry.empty()){ // finish the record that straddled the previous chunk
+				const char* nl = detail::find_char(p, end, delimiter);
+				carry.insert(carry.end(), p, nl);
+				if(nl == end){
+					return;
+				}
+				add_record({carry.data(), carry.size()}, sink);
+				p = nl + 1;
+			}
+			while(p != end){
+				const char* nl = detail::find_char(p, end, delimiter);
+				if(nl == end){
+					break;
+				}
+				add_record({p, static_cast<std::size_t>(nl - p)}, sink);
+				p = nl + 1;
+			}
+			flush(sink); // before touching carry: pending line views may point into it
+			carry.assign(p, end);
+		}
+
+		// Parse whatever is left after the last delimiter. Call once at end of input.
+		template<typename Sink>
+		void finish(Sink&& sink){
+			if(!carry.empty()){
+				add_record({carry.data(), carry.size()}, sink);
+				flush(sink);
+				carry.clear();
+			}
+		}
+
+		[[nodiscard]] std::uint64_t records() const noexcept{ return record_count; }	// valid records passed to a sink
+		[[nodiscard]] std::uint64_t invalid() const noexcept{ return invalid_count; }	// non-empty lines that didn't start with a ULID
+
+	private:
+		static constexpr std::size_t BATCH = 64;
+
+		struct pending_record{
+			std::string_view line;
+			std::uint8_t canonical_index; // slot in canonical_ids, or NOT_CANONICAL
+			bool ok;
+			ulid_t id;
+		};
+		static constexpr std::uint8_t NOT_CANONICAL = 0xFF;
+
+		char delimiter;
+		std::vector<char> carry{};
+		std::array<pending_record, BATCH> pending{};
+		std::size_t pending_count = 0;
+		std::array<char, BATCH * 26> canonical_chars{};
+		std::array<ulid_t, BATCH> canonical_ids{};
+		std::size_t canonical_count = 0;
+		std::uint64_t record_count = 0;
+		std::uint64_t invalid_count = 0;
+
+		template<typename Sink>
+		void add_record(std::string_view line, Sink& sink){
+			if(!line.empty() && line.back() == '\r'){
+				line.remove_suffix(1);
+			}
+			if(line.empty()){
+				return;
+			}
+			// Only the field length matters here: a separator inside it is not a valid digit,
+			// so the decoders reject it anyway.
+			const auto field_ends_at = [line](std::size_t n){
+				return line.size() == n || (line.size() > n && detail::is_field_separator(line[n]));
+			};
+			pending_record& r = pending[pending_count++];
+			r.line = line;
+			r.canonical_index = NOT_CANONICAL;
+			r.ok = false;
+			if(field_ends_at(26)){
+				std::memcpy(canonical_chars.data() + canonical_count * 26, line.data(), 26);
+				r.canonical_index = static_cast<std::uint8_t>(canonical_count++);
+			} else if(field_ends_at(35)){
+				const auto parsed = ulid_t::from_readable_string(line.substr(0, 35));
+				r.ok = parsed.has_value();
+				r.id = parsed.value_or(ulid_t{});
+			}
+			if(pending_count == BATCH){
+				flush(sink);
+			}
+		}
+
+		template<typename Sink>
+		void flush(Sink& sink){
+			std::uint64_t bad = 0;
+			if(canonical_count != 0){
+				decode_many({canonical_chars.data(), canonical_count * 26}, {canonical_ids.data(), canonical_count}, {&bad, 1});
+			}
+			for(std::size_t i = 0; i < pending_count; ++i){
+				pending_record& r = pending[i];
+				if(r.canonical_index != NOT_CANONICAL){
+					r.ok = ((bad >> r.canonical_index) & 1) == 0;
+					r.id = canonical_ids[r.canonical_index];
+				}
+				if(r.ok){
+					++record_count;
+					sink(static_cast<const ulid_t&>(r.id), r.line);
+				} else{
+					++invalid_count;
+				}
+			}
+			pending_count = 0;
+			canonical_count = 0;
+		}
+	};
+} // namespace ulid
@@ -0,0 +1,154 @@
+#pragma once
+#include "ulid.hpp"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ranges>
+#include <span>
+
+// ulid_wire.hpp - binary ULIDs in wire buffers: packed spans and iovec-style scatter lists.
+//
+// Part of cpp_ulid: https://github.com/ulfben/cpp_ulid
+// License: MIT
+//
+// Every form uses the 16-byte big-endian layout of ulid_t::as_bytes() / write_to(), back to back,
+// so the bytes are the same whether a frame is written whole or in pieces.
+//
+//   - ulid::write_many(span<const ulid_t>, span<std::byte>) -> size_t
+//   - ulid::read_many(span<const std::byte>, span<ulid_t>) -> size_t
+//       16 bytes per ID into or out of one packed buffer; as many IDs as fit. Returns the count.
+//
+//   - ulid::write_scatter(span<const ulid_t>, slices) -> size_t
+//   - ulid::read_gather(slices, span<ulid_t>) -> size_t
+//       The same byte stream spread over a list of buffers, e.g. the iovecs of a writev() or
+//       readv(). An ID may straddle two slices. Only whole IDs are written or read: writing
+//       stops at the last ID that fits in the slices' total size. Returns the count.
+//
+// A slice is anything with iov_base / iov_len (POSIX iovec), buf / len (WSABUF) or that converts
+// to span<std::byte>. Each ID that sits inside one slice is a single unaligned store or load.
+
+namespace ulid{
+
+	namespace detail{
+		template<typename S>
+		concept iovec_like = requires(const S& s){ { s.iov_base } -> std::convertible_to<void*>; { s.iov_len } -> std::convertible_to<std::size_t>; };
+		template<typename S>
+		concept wsabuf_like = requires(const S& s){ { s.buf } -> std::convertible_to<char*>; { s.len } -> std::convertible_to<std::size_t>; };
+
+		template<typename S>
+		std::span<std::byte> slice_bytes(const S& s) noexcept{
+			if constexpr(iovec_like<S>){
+				return {static_cast<std::byte*>(s.iov_base), static_cast<std::size_t>(s.iov_len)};
+			} else if constexpr(wsabuf_like<S>){
+				return {reinterpret_cast<std::byte*>(s.buf), static_cast<std::size_t>(s.len)};
+			} else{
+				return std::span<std::byte>{s};
+			}
+		}
+
+		template<typename R>
+		std::size_t total_size(R& slices) noexcept{
+			std::size_t total = 0;
+			for(const auto& s : slices){
+				total += slice_bytes(s).size();
+			}
+			return total;
+		}
+	} // namespace detail
+
+	template<typename S>
+	concept byte_slice = detail::iovec_like<S> || detail::wsabuf_like<S> || std::convertible_to<const S&, std::span<std::byte>>;
+
+	// Returns the number of IDs written: min(ids.size(), out.size() / 16).
+	inline std::size_t write_many(std::span<const ulid_t> ids, std::span<std::byte> out) noexcept{
+		const std::size_t n = ids.size() < out.size() / 16 ? ids.size() : out.size() / 16;
+		for(std::size_t i = 0; i < n; ++i){
+			ids[i].write_to(out.subspan(i * 16, 16));
+		}
+		return n;
+	}
+
+	// Returns the number of IDs read: min(out.size(), in.size() / 16). Any 16 bytes are a valid ULID.
+	inline std::size_t read_many(std::span<const std::byte> in, std::span<ulid_t> out) noexcept{
+		const std::size_t n = out.size() < in.size() / 16 ? out.size() : in.size() / 16;
+		for(std::size_t i = 0; i < n; ++i){
+			out[i] = *ulid_t::read_from(in.subspan(i * 16, 16));
+		}
+		return n;
+	}
+
+	template<std::ranges::forward_range Slices>
+		requires byte_slice<std::ranges::range_value_t<Slices>>
+	std::size_t write_scatter(std::span<const ulid_t> ids, Slices&& slices) noexcept{
+		const std::size_t total = detail::total_size(slices) / 16;
+		const std::size_t n = ids.size() < total ? ids.size() : total;
+		std::size_t i = 0;
+		std::size_t split = 0; // bytes of ids[i] already written to the previous slice
+		for(const auto& s : slices){
+			std::span<std::byte> out = detail::slice_bytes(s);
+			if(split != 0){ // finish the straddling ID
+				std::array<std::byte, 16> bytes{};
+				ids[i].write_to(bytes);
+				const std::size_t k = 16 - split < out.size() ? 16 - split : out.size();
+				std::memcpy(out.data(), bytes.data() + split, k);
+				out = out.subspan(k);
+				split = (split + k) % 16;
+				if(split != 0){
+					continue; // a slice of fewer than 16 bytes, still not done
+				}
+				++i;
+			}
+			for(; i < n && out.size() >= 16; ++i){
+				ids[i].write_to(out);
+				out = out.subspan(16);
+			}
+			if(i == n){
+				break;
+			}
+			if(!out.empty()){ // start the next ID here, finish it in the next slice
+				std::array<std::byte, 16> bytes{};
+				ids[i].write_to(bytes);
+				std::memcpy(out.data(), bytes.data(), out.size());
+				split = out.size();
+			}
+		}
+		return n;
+	}
+
+	template<std::ranges::forward_range Slices>
+		requires byte_slice<std::ranges::range_value_t<Slices>>
+	std::size_t read_gather(Slices&& slices, std::span<ulid_t> out) noexcept{
+		const std::size_t total = detail::total_size(slices) / 16;
+		const std::size_t n = out.size() < total ? out.size() : total;
+		std::size_t i = 0;
+		std::array<std::byte, 16> pending{};
+		std::size_t split = 0; // bytes of out[i] gathered from previous slices
+		for(const auto& s : slices){
+			std::span<const std::byte> in = detail::slice_bytes(s);
+			if(split != 0){
+				const std::size_t k = 16 - split < in.size() ? 16 - split : in.size();
+				std::memcpy(pending.data() + split, in.data(), k);
+				in = in.subspan(k);
+				split = (split + k) % 16;
+				if(split != 0){
+					continue;
+				}
+				out[i++] = *ulid_t::read_from(pending);
+			}
+			for(; i < n && in.size() >= 16; ++i){
+				out[i] = *ulid_t::read_from(in);
+				in = in.subspan(16);
+			}
+			if(i == n){
+				break;
+			}
+			if(!in.empty()){
+				std::memcpy(pending.data(), in.data(), in.size());
+				split = in.size();
+			}
+		}
+		return n;
+	}
+} // namespace ulid